@@ -137,6 +137,12 @@ class ScatteringData {
    * transform data in spectral format.
    */
   sht::SHT get_sht();
+  // pxx :: hide
+  /** Shared SHT instance.
+   * @return Handle to the SHT instance obtained from the SHTProvider
+   * that is compatible with the data in spectral format.
+   */
+  std::shared_ptr<const sht::SHT> get_sht_ptr();
   /// Length-1 vector containing the frequency corresponding to the scattering data.
   eigen::Vector<double> get_f_grid() {return eigen::Vector<double>::Constant(1, frequency_);}
   /// Length-1 vector containing the temperature corresponding to the scattering data.
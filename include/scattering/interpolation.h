@@ -9,15 +9,31 @@
 #define __SCATTERING_INTERPOLATION__
 
 #include <scattering/eigen.h>
+#include <Eigen/Sparse>
 
 #include <algorithm>
+#include <atomic>
+#include <cmath>
 #include <utility>
 #include <chrono>
 #include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
 #include <type_traits>
 #include <vector>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 namespace scattering {
+
+// pxx :: export
+/// Enum class to represent the different interpolation methods.
+enum class InterpolationMethod { Linear = 0, Cubic = 1 };
+
 namespace detail {
 
 //
@@ -30,6 +46,84 @@ struct is_vector {
       (Derived::RowsAtCompileTime == 1) || (Derived::ColsAtCompileTime == 1);
 };
 
+template <typename T>
+struct is_map : std::false_type {};
+
+template <typename Derived>
+struct is_map<Eigen::Map<Derived>> : std::true_type {};
+
+/** Multilinear interpolation kernel.
+ *
+ * Interpolates a contiguous, row-major tensor along its N leading
+ * dimensions. The 2^N corner weights and offsets of the interpolation
+ * cell are computed once, after which the corner slices are combined in a
+ * single pass over the output. Since N is known at compile time, the
+ * loops over the corners are unrolled.
+ *
+ * @tparam N The number of leading dimensions to interpolate.
+ */
+template <Eigen::Index N>
+struct InterpolationKernel {
+  static constexpr Eigen::Index n_corners = 1 << N;
+
+  /** Interpolate tensor.
+   * @param output Pointer to the output buffer holding slice_size elements.
+   * @param data Pointer to the tensor data.
+   * @param dimensions The N leading dimensions of the tensor.
+   * @param slice_size The product of the remaining dimensions.
+   * @param weights The weights of the left boundaries of the interpolation
+   * cell.
+   * @param indices The indices of the left boundaries of the interpolation
+   * cell.
+   */
+  template <typename Coefficient, typename WeightVector, typename IndexVector>
+  __attribute__((always_inline)) static inline void compute(
+      Coefficient *output,
+      const Coefficient *data,
+      const std::array<Eigen::Index, N> &dimensions,
+      Eigen::Index slice_size,
+      const WeightVector &weights,
+      const IndexVector &indices) {
+    using Real = decltype(std::real(std::declval<Coefficient>()));
+
+    std::array<Eigen::Index, N> strides;
+    Eigen::Index stride = slice_size;
+    for (Eigen::Index i = N - 1; i >= 0; --i) {
+      strides[i] = stride;
+      stride *= dimensions[i];
+    }
+
+    // Right neighbours of boundary points have zero weight and are
+    // clamped to stay within the tensor.
+    std::array<Real, n_corners> corner_weights;
+    std::array<const Coefficient *, n_corners> corners;
+    for (Eigen::Index c = 0; c < n_corners; ++c) {
+      Real w = 1.0;
+      Eigen::Index offset = 0;
+      for (Eigen::Index i = 0; i < N; ++i) {
+        Eigen::Index index = indices[i];
+        if (c & (1 << i)) {
+          w *= static_cast<Real>(1.0) - static_cast<Real>(weights[i]);
+          index = std::min(index + 1, dimensions[i] - 1);
+        } else {
+          w *= static_cast<Real>(weights[i]);
+        }
+        offset += index * strides[i];
+      }
+      corner_weights[c] = w;
+      corners[c] = data + offset;
+    }
+
+    for (Eigen::Index j = 0; j < slice_size; ++j) {
+      Coefficient sum = corner_weights[0] * corners[0][j];
+      for (Eigen::Index c = 1; c < n_corners; ++c) {
+        sum += corner_weights[c] * corners[c][j];
+      }
+      output[j] = sum;
+    }
+  }
+};
+
 template <typename T, Eigen::Index N>
 struct InterpolationResult {
     using Scalar = typename T::Scalar;
@@ -261,6 +355,60 @@ template <typename Scalar>
 using WeightIndexPair =
     std::pair<eigen::Vector<Scalar>, eigen::Vector<Eigen::Index>>;
 
+/** Check whether a grid is uniform.
+ *
+ * The check is only used to select the search strategy in
+ * calculate_weights, so a loose tolerance is sufficient.
+ *
+ * @param grid The grid to check.
+ * @return True if all grid steps are the same up to a relative tolerance.
+ */
+template <typename GridVector>
+bool is_uniform(const GridVector& grid) {
+  eigen::Index n = grid.size();
+  if (n < 3) {
+    return false;
+  }
+  double dx = (grid[n - 1] - grid[0]) / static_cast<double>(n - 1);
+  if (!(dx > 0.0)) {
+    return false;
+  }
+  for (eigen::Index i = 1; i < n; ++i) {
+    double step = grid[i] - grid[i - 1];
+    if (std::abs(step - dx) > 1e-3 * dx) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/** Check whether positions are sorted in ascending order.
+ * @param positions The positions to check.
+ * @return True if the positions are in non-decreasing order.
+ */
+template <typename PositionVector>
+bool is_sorted(const PositionVector& positions) {
+  for (eigen::Index i = 1; i < positions.size(); ++i) {
+    if (positions[i] < positions[i - 1]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/** Calculate linear interpolation weights and indices.
+ *
+ * @param weights Vector to which to write the weights of the left grid
+ * points.
+ * @param indices Vector to which to write the indices of the left grid
+ * points.
+ * @param grid The grid to interpolate from.
+ * @param positions The positions to interpolate to.
+ * @param extrapolate Whether to extrapolate linearly or to use the boundary
+ * values for positions outside the grid.
+ * @param uniform Whether the grid is uniform as determined by is_uniform().
+ * This only selects the search strategy and doesn't affect the results.
+ */
 template <typename WeightVector,
           typename IndexVector,
           typename GridVector,
@@ -269,16 +417,19 @@ void calculate_weights(WeightVector&& weights,
                        IndexVector&& indices,
                        const GridVector& grid,
                        const PositionVector& positions,
-                       bool extrapolate=false) {
+                       bool extrapolate,
+                       bool uniform) {
   using Scalar = typename std::remove_reference<WeightVector>::type::Scalar;
+  eigen::Index n = grid.size();
 
-  for (int i = 0; i < positions.size(); ++i) {
+  // Sets weights and indices of position i given the index f of the first
+  // grid point not less than the position, i.e. the result of lower_bound.
+  auto set_weights = [&](eigen::Index i, eigen::Index f) {
     auto p = positions[i];
-    auto f = std::lower_bound(grid.begin(), grid.end(), p);
-    if ((f != grid.begin()) && (f != grid.end())) {
+    if ((f != 0) && (f != n)) {
       // p is within grid limits.
-          indices[i] = f - grid.begin();
-          if (*f != p) {
+          indices[i] = f;
+          if (grid[f] != p) {
               indices[i] -= 1;
           }
           Scalar l = grid[indices[i]];
@@ -289,7 +440,7 @@ void calculate_weights(WeightVector&& weights,
               weights[i] = (r - p) / (r - l);
           }
       } else {
-          if (f == grid.begin()) {
+          if (f == 0) {
               // p is left of lower limit.
               if (extrapolate) {
                   indices[i] = 0;
@@ -303,19 +454,73 @@ void calculate_weights(WeightVector&& weights,
           } else {
               // p is right of upper limit.
               if (extrapolate) {
-                  indices[i] = grid.size() - 2;
+                  indices[i] = n - 2;
                   Scalar l = grid[indices[i]];
                   Scalar r = grid[indices[i] + 1];
                   weights[i] = - (p - r) / (r - l);
               } else {
-                  indices[i] = grid.size() - 1;
+                  indices[i] = n - 1;
                   weights[i] = 1.0;
               }
           }
       }
+  };
+
+  if (uniform) {
+    // Estimate position from grid step and correct for rounding errors.
+    double x_0 = grid[0];
+    double dx = (grid[n - 1] - grid[0]) / static_cast<double>(n - 1);
+    for (eigen::Index i = 0; i < positions.size(); ++i) {
+      auto p = positions[i];
+      double x = std::ceil((p - x_0) / dx);
+      if (!(x > 0.0)) {
+        x = 0.0;
+      } else if (x > n) {
+        x = n;
+      }
+      eigen::Index f = static_cast<eigen::Index>(x);
+      while ((f > 0) && (grid[f - 1] >= p)) {
+        --f;
+      }
+      while ((f < n) && (grid[f] < p)) {
+        ++f;
+      }
+      set_weights(i, f);
+    }
+  } else if (is_sorted(positions)) {
+    // Merge-walk through grid and sorted positions.
+    eigen::Index f = 0;
+    for (eigen::Index i = 0; i < positions.size(); ++i) {
+      auto p = positions[i];
+      while ((f < n) && (grid[f] < p)) {
+        ++f;
+      }
+      set_weights(i, f);
+    }
+  } else {
+    for (eigen::Index i = 0; i < positions.size(); ++i) {
+      auto p = positions[i];
+      auto f = std::lower_bound(grid.begin(), grid.end(), p);
+      set_weights(i, f - grid.begin());
+    }
   }
 }
 
+template <typename WeightVector,
+          typename IndexVector,
+          typename GridVector,
+          typename PositionVector>
+void calculate_weights(WeightVector&& weights,
+                       IndexVector&& indices,
+                       const GridVector& grid,
+                       const PositionVector& positions,
+                       bool extrapolate=false) {
+  // Detecting a uniform grid takes a pass over the grid, so it is only
+  // done when there are at least as many positions as grid points.
+  bool uniform = (positions.size() >= grid.size()) && is_uniform(grid);
+  calculate_weights(weights, indices, grid, positions, extrapolate, uniform);
+}
+
 template <typename Scalar>
 WeightIndexPair<Scalar> calculate_weights(
     const eigen::Vector<Scalar>& grid,
@@ -341,6 +546,98 @@ WeightIndexPair<Scalar> calculate_weights(
   return std::make_pair(weights, indices);
 }
 
+template <typename Scalar>
+using StencilIndexPair =
+    std::pair<eigen::MatrixFixedRows<Scalar, 4>, eigen::Vector<Eigen::Index>>;
+
+/** Calculate stencils for cubic interpolation.
+ *
+ * Cubic Hermite interpolation with the node derivatives estimated from
+ * quadratic fits through the neighbouring nodes, which are one-sided at the
+ * grid boundaries. The interpolant is continuously differentiable and
+ * exact for quadratic functions. Since it is linear in the data, the value
+ * at each position is a weighted sum of the four grid points starting at
+ * the returned index. For grids with less than four points, linear
+ * interpolation is used and the weights of missing points are zero.
+ *
+ * @param grid The grid to interpolate from.
+ * @param positions The positions to interpolate to.
+ * @param extrapolate Whether to extrapolate using the cubic polynomial of
+ * the boundary interval or to use the boundary value.
+ * @return Pair containing the matrix of stencil weights and the vector of
+ * the indices of the first stencil point.
+ */
+template <typename Scalar>
+StencilIndexPair<Scalar> calculate_cubic_weights(
+    const eigen::Vector<Scalar>& grid,
+    const eigen::Vector<Scalar>& positions,
+    bool extrapolate=false) {
+  using eigen::Index;
+  Index n = grid.size();
+  Index n_positions = positions.size();
+  eigen::MatrixFixedRows<Scalar, 4> stencils =
+      eigen::MatrixFixedRows<Scalar, 4>::Zero(n_positions, 4);
+  eigen::Vector<Index> starts = eigen::Vector<Index>::Zero(n_positions);
+
+  eigen::Vector<Scalar> weights;
+  eigen::Vector<Index> indices;
+  std::tie(weights, indices) =
+      calculate_weights<Scalar>(grid, positions, extrapolate);
+
+  if (n < 4) {
+    for (Index i = 0; i < n_positions; ++i) {
+      stencils(i, indices[i]) = weights[i];
+      if ((weights[i] != 1.0) && (indices[i] + 1 < n)) {
+        stencils(i, indices[i] + 1) = 1.0 - weights[i];
+      }
+    }
+    return std::make_pair(stencils, starts);
+  }
+
+  // Adds c times the derivative estimate at node j to the stencil of
+  // position i.
+  auto add_derivative = [&](Index i, Index j, Scalar c) {
+    Index s = starts[i];
+    if (j == 0) {
+      Scalar h_0 = grid[1] - grid[0];
+      Scalar h_1 = grid[2] - grid[1];
+      stencils(i, 0 - s) -= c * (2.0 * h_0 + h_1) / (h_0 * (h_0 + h_1));
+      stencils(i, 1 - s) += c * (h_0 + h_1) / (h_0 * h_1);
+      stencils(i, 2 - s) -= c * h_0 / (h_1 * (h_0 + h_1));
+    } else if (j == n - 1) {
+      Scalar h_0 = grid[n - 1] - grid[n - 2];
+      Scalar h_1 = grid[n - 2] - grid[n - 3];
+      stencils(i, n - 1 - s) += c * (2.0 * h_0 + h_1) / (h_0 * (h_0 + h_1));
+      stencils(i, n - 2 - s) -= c * (h_0 + h_1) / (h_0 * h_1);
+      stencils(i, n - 3 - s) += c * h_0 / (h_1 * (h_0 + h_1));
+    } else {
+      Scalar h_l = grid[j] - grid[j - 1];
+      Scalar h_r = grid[j + 1] - grid[j];
+      stencils(i, j - 1 - s) -= c * h_r / (h_l * (h_l + h_r));
+      stencils(i, j - s) += c * (h_r - h_l) / (h_l * h_r);
+      stencils(i, j + 1 - s) += c * h_l / (h_r * (h_l + h_r));
+    }
+  };
+
+  for (Index i = 0; i < n_positions; ++i) {
+    Index k = indices[i];
+    Scalar t = 1.0 - weights[i];
+    if (k == n - 1) {
+      k = n - 2;
+      t = 1.0;
+    }
+    starts[i] = std::min(std::max<Index>(k - 1, 0), n - 4);
+    Scalar h = grid[k + 1] - grid[k];
+    Scalar t2 = t * t;
+    Scalar t3 = t2 * t;
+    stencils(i, k - starts[i]) += 2.0 * t3 - 3.0 * t2 + 1.0;
+    stencils(i, k + 1 - starts[i]) += -2.0 * t3 + 3.0 * t2;
+    add_derivative(i, k, h * (t3 - 2.0 * t2 + t));
+    add_derivative(i, k + 1, h * (t3 - t2));
+  }
+  return std::make_pair(stencils, starts);
+}
+
 }
 
 // pxx :: export
@@ -380,9 +677,42 @@ template <typename Tensor, size_t degree, typename Scalar>
         weights,
     Eigen::Ref<const eigen::VectorFixedSize<Eigen::Index, degree>>
         indices) {
-  return detail::Interpolator<Tensor, degree>::compute(tensor,
-                                                       weights,
-                                                       indices);
+  if constexpr (detail::is_map<Tensor>::value) {
+    return detail::Interpolator<Tensor, degree>::compute(tensor,
+                                                         weights,
+                                                         indices);
+  } else {
+    using Result = typename detail::InterpolationResult<Tensor, degree>::type;
+    constexpr Eigen::Index rank = Tensor::NumIndices;
+    auto dimensions = tensor.dimensions();
+    std::array<Eigen::Index, degree> leading_dimensions;
+    for (size_t i = 0; i < degree; ++i) {
+      leading_dimensions[i] = dimensions[i];
+    }
+    if constexpr (degree < rank) {
+      std::array<Eigen::Index, rank - degree> result_dimensions;
+      for (Eigen::Index i = degree; i < rank; ++i) {
+        result_dimensions[i - degree] = dimensions[i];
+      }
+      Result result{result_dimensions};
+      detail::InterpolationKernel<degree>::compute(result.data(),
+                                                   tensor.data(),
+                                                   leading_dimensions,
+                                                   result.size(),
+                                                   weights,
+                                                   indices);
+      return result;
+    } else {
+      Result result;
+      detail::InterpolationKernel<degree>::compute(&result,
+                                                   tensor.data(),
+                                                   leading_dimensions,
+                                                   1,
+                                                   weights,
+                                                   indices);
+      return result;
+    }
+  }
 }
 
 // pxx :: export
@@ -390,7 +720,9 @@ template <typename Tensor, size_t degree, typename Scalar>
 //
 /** Regular grid interpolator.
  *
- * Piecewise-linear interpolator on regular grids.
+ * Piecewise-linear or cubic interpolator on regular grids. The cubic
+ * interpolation is only used when interpolating at given positions.
+ * Precomputed interpolation weights are always linear.
  *
  * @tparam Tensor The Eigen tensor type to interpolate.
  * @tparam degree Along how many dimensions to interpolate.
@@ -408,8 +740,16 @@ class RegularGridInterpolator {
   /** Sets up the interpolator for given grids.
    * \grids Array containing the grids corresponding to the first degree
    * dimensions of the tensor to interpolate.
+   * @param method The interpolation method to use.
    */
-  RegularGridInterpolator(std::array<Vector, degree> grids) : grids_(grids) {}
+  RegularGridInterpolator(
+      std::array<Vector, degree> grids,
+      InterpolationMethod method = InterpolationMethod::Linear)
+      : grids_(grids), method_(method) {
+    for (size_t i = 0; i < degree; ++i) {
+      uniform_[i] = detail::is_uniform(grids_[i]);
+    }
+  }
 
   /** Compute interpolation weights and indices for interpolation points.
    * @param positions Eigen matrix containing the positions at which to
@@ -424,11 +764,39 @@ class RegularGridInterpolator {
       detail::calculate_weights(weights.col(i),
                                 indices.col(i),
                                 grids_[i],
-                                positions.col(i));
+                                positions.col(i),
+                                false,
+                                uniform_[i]);
     }
     return std::make_pair(weights, indices);
   }
 
+  // pxx :: hide
+  /** Compute interpolation weights and indices in place.
+   *
+   * The memory of the given weights is reused if the number of positions
+   * doesn't change, so that repeated calls don't allocate.
+   *
+   * @param interp_weights The weights and indices to overwrite.
+   * @param positions Eigen matrix containing the positions at which to
+   * interpolate the given tensor.
+   */
+  void calculate_weights(
+      InterpolationWeights& interp_weights,
+      const eigen::MatrixFixedRows<Scalar, degree>& positions) const {
+    WeightMatrix& weights = std::get<0>(interp_weights);
+    IndexMatrix& indices = std::get<1>(interp_weights);
+    weights.resize(positions.rows(), degree);
+    indices.resize(positions.rows(), degree);
+    for (size_t i = 0; i < degree; ++i) {
+      detail::calculate_weights(weights.col(i),
+                                indices.col(i),
+                                grids_[i],
+                                positions.col(i),
+                                false,
+                                uniform_[i]);
+    }
+  }
 
   /** Interpolate tensor using precomputed weights.
    * @param t The tensor to interpolate.
@@ -471,15 +839,93 @@ class RegularGridInterpolator {
   void interpolate(ResultContainer results,
                    const Tensor& t,
                    const InterpolationWeights& interp_weights) const {
+    interpolate(results.data(), t, interp_weights);
+  }
+
+  // pxx :: hide
+  /** Interpolate tensor into contiguous buffer.
+   *
+   * The results for the different positions are written consecutively
+   * into the output buffer, each with the layout of the tensor with its
+   * first degree dimensions removed.
+   *
+   * @param output Pointer to a buffer holding n_positions times the
+   * product of the non-interpolated dimensions of t elements.
+   * @param t The tensor to interpolate.
+   * @param interp_weights The interpolation weights precomuted using the
+   * calculate weights member function.
+   */
+  template <typename Coefficient>
+  void interpolate(Coefficient* output,
+                   const Tensor& t,
+                   const InterpolationWeights& interp_weights) const {
     const WeightMatrix& weights = std::get<0>(interp_weights);
     const IndexMatrix& indices = std::get<1>(interp_weights);
 
-    int n_results = weights.rows();
-    for (int i = 0; i < n_results; ++i) {
-        eigen::tensor_index<1>(results, {i}) = scattering::interpolate<Tensor, degree, Scalar>(t,
-                                                                                    weights.row(i),
-                                                                                    indices.row(i));
+    std::array<Eigen::Index, degree> dimensions;
+    Eigen::Index slice_size = t.size();
+    for (size_t i = 0; i < degree; ++i) {
+      dimensions[i] = t.dimension(i);
+      slice_size /= dimensions[i];
+    }
+
+    Eigen::Index n_results = weights.rows();
+    for (Eigen::Index i = 0; i < n_results; ++i) {
+      detail::InterpolationKernel<degree>::compute(output + i * slice_size,
+                                                   t.data(),
+                                                   dimensions,
+                                                   slice_size,
+                                                   weights.row(i),
+                                                   indices.row(i));
+    }
+  }
+
+  // pxx :: hide
+  /** Interpolate tensor into contiguous buffer reusing workspace.
+   *
+   * @param output Pointer to a buffer holding n_positions times the
+   * product of the non-interpolated dimensions of t elements.
+   * @param t The tensor to interpolate.
+   * @param positions Eigen matrix containing the positions at which to
+   * interpolate t.
+   * @param workspace Interpolation weights that are overwritten and whose
+   * memory is reused across calls.
+   */
+  template <typename Coefficient>
+  void interpolate(Coefficient* output,
+                   const Tensor& t,
+                   const eigen::MatrixFixedRows<Scalar, degree>& positions,
+                   InterpolationWeights& workspace) const {
+    if (method_ == InterpolationMethod::Cubic) {
+      interpolate_cubic(output, t, positions);
+      return;
+    }
+    calculate_weights(workspace, positions);
+    interpolate(output, t, workspace);
+  }
+
+  /** Interpolate tensor at multiple positions.
+   *
+   * @param t The tensor to interpolate.
+   * @param positions Eigen matrix containing the positions at which to
+   * interpolate t.
+   * @return Tensor whose first dimension corresponds to the positions and
+   * whose remaining dimensions are the non-interpolated dimensions of t.
+   */
+  eigen::Tensor<typename Tensor::Scalar, Tensor::NumIndices - degree + 1>
+  interpolate_batch(
+      const Tensor& t,
+      const eigen::MatrixFixedRows<Scalar, degree>& positions) const {
+    std::array<Eigen::Index, Tensor::NumIndices - degree + 1> dimensions;
+    dimensions[0] = positions.rows();
+    for (Eigen::Index i = degree; i < Tensor::NumIndices; ++i) {
+      dimensions[i - degree + 1] = t.dimension(i);
     }
+    eigen::Tensor<typename Tensor::Scalar, Tensor::NumIndices - degree + 1>
+        results{dimensions};
+    InterpolationWeights workspace;
+    interpolate(results.data(), t, positions, workspace);
+    return results;
   }
 
   /** Interpolate tensor at given positions.
@@ -491,50 +937,333 @@ class RegularGridInterpolator {
                    eigen::MatrixFixedRows<Scalar, degree> positions) const
       -> std::vector<
       typename detail::InterpolationResult<Tensor, degree>::type> {
-      auto interp_weights = calculate_weights(positions);
-      return interpolate(t, interp_weights);
+    if (method_ == InterpolationMethod::Cubic) {
+      using ResultType =
+          typename detail::InterpolationResult<Tensor, degree>::type;
+      std::array<Eigen::Index, Tensor::NumIndices - degree> dimensions;
+      for (Eigen::Index i = degree; i < Tensor::NumIndices; ++i) {
+        dimensions[i - degree] = t.dimension(i);
+      }
+      std::vector<ResultType> results(positions.rows());
+      for (auto& result : results) {
+        result = ResultType(dimensions);
+      }
+      auto batch = interpolate_batch(t, positions);
+      Eigen::Index slice_size = batch.size() / std::max<Eigen::Index>(positions.rows(), 1);
+      for (size_t i = 0; i < results.size(); ++i) {
+        std::copy(batch.data() + i * slice_size,
+                  batch.data() + (i + 1) * slice_size,
+                  results[i].data());
+      }
+      return results;
+    }
+    auto interp_weights = calculate_weights(positions);
+    return interpolate(t, interp_weights);
   }
 
  protected:
+  /** Cubic interpolation into contiguous buffer.
+   *
+   * Sums the tensor product of the cubic stencils along the interpolated
+   * dimensions.
+   *
+   * @param output Pointer to a buffer holding n_positions times the
+   * product of the non-interpolated dimensions of t elements.
+   * @param t The tensor to interpolate.
+   * @param positions Eigen matrix containing the positions at which to
+   * interpolate t.
+   */
+  template <typename Coefficient>
+  void interpolate_cubic(
+      Coefficient* output,
+      const Tensor& t,
+      const eigen::MatrixFixedRows<Scalar, degree>& positions) const {
+    using ArrayMap = Eigen::Map<Eigen::Array<Coefficient, Eigen::Dynamic, 1>>;
+    using ConstArrayMap =
+        Eigen::Map<const Eigen::Array<Coefficient, Eigen::Dynamic, 1>>;
+
+    std::array<Eigen::Index, degree> strides;
+    Eigen::Index slice_size = t.size();
+    for (size_t i = 0; i < degree; ++i) {
+      slice_size /= t.dimension(i);
+    }
+    Eigen::Index stride = slice_size;
+    for (Eigen::Index i = degree - 1; i >= 0; --i) {
+      strides[i] = stride;
+      stride *= t.dimension(i);
+    }
+
+    std::array<detail::StencilIndexPair<Scalar>, degree> stencils;
+    for (size_t i = 0; i < degree; ++i) {
+      eigen::Vector<Scalar> grid = grids_[i];
+      eigen::Vector<Scalar> positions_i = positions.col(i);
+      stencils[i] = detail::calculate_cubic_weights<Scalar>(grid, positions_i);
+    }
+
+    Eigen::Index n_corners = 1;
+    for (size_t i = 0; i < degree; ++i) {
+      n_corners *= 4;
+    }
+    for (Eigen::Index i = 0; i < positions.rows(); ++i) {
+      ArrayMap result(output + i * slice_size, slice_size);
+      result.setZero();
+      for (Eigen::Index c = 0; c < n_corners; ++c) {
+        Scalar weight = 1.0;
+        Eigen::Index offset = 0;
+        Eigen::Index corner = c;
+        for (Eigen::Index j = degree - 1; j >= 0; --j) {
+          Eigen::Index k = corner % 4;
+          corner /= 4;
+          weight *= std::get<0>(stencils[j])(i, k);
+          offset += (std::get<1>(stencils[j])[i] + k) * strides[j];
+        }
+        if (weight != 0.0) {
+          result += weight * ConstArrayMap(t.data() + offset, slice_size);
+        }
+      }
+    }
+  }
+
   std::array<Vector, degree> grids_;
+  std::array<bool, degree> uniform_;
+  InterpolationMethod method_;
 };
 
-template <int ... Axis>
-struct RegridImpl;
-
-template <int i, int a, int... Axis>
-struct RegridImpl<i, a, Axis...> {
-  template <typename Tensor, typename Weights, typename Indices>
-      __attribute__((always_inline)) auto static inline compute(const Tensor& t,
-                             std::array<Eigen::DenseIndex, Tensor::NumIndices> coords,
-                             const Weights& weights,
-                             const Indices& indices) {
-    auto w = weights[i][coords[a]];
-    auto index = indices[i][coords[a]];
-    decltype(coords) new_coords = coords;
-
-    new_coords[a] = index;
-    auto l = RegridImpl<i + 1, Axis...>::compute(t, new_coords, weights, indices);
-    if (w == 1.0) {
-      return l;
-    }
-    new_coords[a] += 1;
-    auto r = RegridImpl<i + 1, Axis...>::compute(t, new_coords, weights, indices);
-    return w * l + r * (static_cast<decltype(w)>(1.0) - w);
+namespace detail {
+
+/// The number of threads used by RegularRegridder. Regridders read it
+/// once per call, so it may be changed while other threads regrid.
+inline std::atomic<eigen::Index> regridder_n_threads{1};
+
+/** Linear interpolation along a single tensor axis.
+ *
+ * Input and output are contiguous arrays viewed as rank-3 tensors of shape
+ * (n_outer, n_in, n_inner) and (n_outer, n_out, n_inner), respectively,
+ * where the second dimension is the axis to interpolate. Each output slice
+ * along the axis is a linear combination of two contiguous input slices,
+ * so that the inner loop is a vectorized operation over n_inner elements.
+ *
+ * @param output Pointer to the output data.
+ * @param input Pointer to the input data.
+ * @param n_outer The product of the dimensions before the axis.
+ * @param n_in The size of the axis in the input.
+ * @param n_inner The product of the dimensions after the axis.
+ * @param weights The interpolation weights of the left neighbours.
+ * @param indices The indices of the left neighbours.
+ * @param n_threads The number of threads over which to distribute the
+ * output slices.
+ */
+template <typename Coefficient, typename Scalar>
+void regrid_axis(Coefficient *output,
+                 const Coefficient *input,
+                 eigen::Index n_outer,
+                 eigen::Index n_in,
+                 eigen::Index n_inner,
+                 const eigen::Vector<Scalar> &weights,
+                 const eigen::Vector<eigen::Index> &indices,
+                 [[maybe_unused]] eigen::Index n_threads = 1) {
+  using ArrayMap = Eigen::Map<Eigen::Array<Coefficient, Eigen::Dynamic, 1>>;
+  using ConstArrayMap =
+      Eigen::Map<const Eigen::Array<Coefficient, Eigen::Dynamic, 1>>;
+  eigen::Index n_out = weights.size();
+  // Each output slice is written by exactly one thread, so the results
+  // don't depend on the number of threads.
+#ifdef _OPENMP
+#pragma omp parallel for collapse(2) num_threads(n_threads) if (n_threads > 1)
+#endif
+  for (eigen::Index i = 0; i < n_outer; ++i) {
+    for (eigen::Index j = 0; j < n_out; ++j) {
+      const Coefficient *source = input + i * n_in * n_inner;
+      Coefficient *destination = output + i * n_out * n_inner;
+      Scalar w = weights[j];
+      const Coefficient *left = source + indices[j] * n_inner;
+      ArrayMap result(destination + j * n_inner, n_inner);
+      if (w == 1.0) {
+        result = ConstArrayMap(left, n_inner);
+      } else {
+        result = w * ConstArrayMap(left, n_inner) +
+                 (static_cast<Scalar>(1.0) - w) *
+                     ConstArrayMap(left + n_inner, n_inner);
+      }
+    }
+  }
+}
+
+/** Cubic interpolation along a single tensor axis.
+ *
+ * Same as regrid_axis but each output slice is a linear combination of
+ * the four input slices given by the stencils calculated using
+ * calculate_cubic_weights.
+ *
+ * @param output Pointer to the output data.
+ * @param input Pointer to the input data.
+ * @param n_outer The product of the dimensions before the axis.
+ * @param n_in The size of the axis in the input.
+ * @param n_inner The product of the dimensions after the axis.
+ * @param stencils The stencil weights.
+ * @param indices The indices of the first stencil point.
+ * @param n_threads The number of threads over which to distribute the
+ * output slices.
+ */
+template <typename Coefficient, typename Scalar>
+void regrid_axis_cubic(Coefficient *output,
+                       const Coefficient *input,
+                       eigen::Index n_outer,
+                       eigen::Index n_in,
+                       eigen::Index n_inner,
+                       const eigen::MatrixFixedRows<Scalar, 4> &stencils,
+                       const eigen::Vector<eigen::Index> &indices,
+                       [[maybe_unused]] eigen::Index n_threads = 1) {
+  using ArrayMap = Eigen::Map<Eigen::Array<Coefficient, Eigen::Dynamic, 1>>;
+  using ConstArrayMap =
+      Eigen::Map<const Eigen::Array<Coefficient, Eigen::Dynamic, 1>>;
+  eigen::Index n_out = indices.size();
+#ifdef _OPENMP
+#pragma omp parallel for collapse(2) num_threads(n_threads) if (n_threads > 1)
+#endif
+  for (eigen::Index i = 0; i < n_outer; ++i) {
+    for (eigen::Index j = 0; j < n_out; ++j) {
+      const Coefficient *source = input + i * n_in * n_inner;
+      Coefficient *destination = output + i * n_out * n_inner;
+      const Coefficient *left = source + indices[j] * n_inner;
+      ArrayMap result(destination + j * n_inner, n_inner);
+      result = stencils(j, 0) * ConstArrayMap(left, n_inner);
+      for (eigen::Index k = 1; k < 4; ++k) {
+        if (stencils(j, k) != 0.0) {
+          result += stencils(j, k) * ConstArrayMap(left + k * n_inner, n_inner);
+        }
+      }
+    }
+  }
+}
+
+}  // namespace detail
+
+////////////////////////////////////////////////////////////////////////////////
+// Interpolation plans
+////////////////////////////////////////////////////////////////////////////////
+
+/** Interpolation plan.
+ *
+ * Holds the weights and indices for the interpolation from one grid
+ * to another. For linear interpolation, these are the weights and indices
+ * of the left neighbours. For cubic interpolation, these are the four-point
+ * stencils and the indices of their first points. Plans are immutable and can therefore be shared between
+ * regridders and data fields. Plans obtained using get(...) are cached
+ * by the contents of the grids, so that the weights for a grid pair that
+ * is used repeatedly, for example for all particles of a habit, are
+ * computed only once.
+ *
+ * @tparam Scalar The floating point type used to represent the grids.
+ */
+template <typename Scalar>
+class InterpolationPlan {
+ public:
+  /** Create interpolation plan.
+   * @param old_grid The grid to interpolate from.
+   * @param new_grid The grid to interpolate to.
+   * @param extrapolate Whether to extrapolate outside of the old grid.
+   * @param method The interpolation method.
+   */
+  InterpolationPlan(const eigen::Vector<Scalar> &old_grid,
+                    const eigen::Vector<Scalar> &new_grid,
+                    bool extrapolate = false,
+                    InterpolationMethod method = InterpolationMethod::Linear)
+      : n_old_(old_grid.size()),
+        method_(method),
+        identity_((old_grid.size() == new_grid.size()) &&
+                  (old_grid == new_grid)) {
+    if (method_ == InterpolationMethod::Cubic) {
+      std::tie(stencils_, indices_) =
+          detail::calculate_cubic_weights<Scalar>(old_grid,
+                                                  new_grid,
+                                                  extrapolate);
+    } else {
+      std::tie(weights_, indices_) =
+          detail::calculate_weights<Scalar>(old_grid, new_grid, extrapolate);
+    }
+  }
+
+  /** Get cached interpolation plan.
+   * @param old_grid The grid to interpolate from.
+   * @param new_grid The grid to interpolate to.
+   * @param extrapolate Whether to extrapolate outside of the old grid.
+   * @param method The interpolation method.
+   * @return Shared pointer to the plan for the given grids.
+   */
+  static std::shared_ptr<const InterpolationPlan> get(
+      const eigen::Vector<Scalar> &old_grid,
+      const eigen::Vector<Scalar> &new_grid,
+      bool extrapolate = false,
+      InterpolationMethod method = InterpolationMethod::Linear) {
+    Key key{std::vector<Scalar>(old_grid.begin(), old_grid.end()),
+            std::vector<Scalar>(new_grid.begin(), new_grid.end()),
+            extrapolate,
+            method};
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto found = cache_.find(key);
+      if (found != cache_.end()) {
+        return found->second;
+      }
+    }
+    auto plan = std::make_shared<const InterpolationPlan>(old_grid,
+                                                          new_grid,
+                                                          extrapolate,
+                                                          method);
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (cache_.size() >= max_cache_size) {
+      cache_.clear();
+    }
+    cache_.emplace(std::move(key), plan);
+    return plan;
   }
-};
 
-template <int i>
-struct RegridImpl<i> {
-  template <typename Tensor, typename Weights, typename Indices>
-      __attribute__((always_inline)) auto static inline compute(const Tensor& t,
-                             std::array<Eigen::DenseIndex, Tensor::NumIndices> coords,
-                             const Weights&/*weights*/,
-                             const Indices&/*indices*/) {
-    return t(coords);
+  /// Remove all plans from the cache.
+  static void clear_cache() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    cache_.clear();
   }
+
+  /// The size of the grid to interpolate from.
+  eigen::Index get_n_old() const { return n_old_; }
+  /// The size of the grid to interpolate to.
+  eigen::Index get_n_new() const { return indices_.size(); }
+  /// The interpolation method.
+  InterpolationMethod get_method() const { return method_; }
+  /// Whether the old and new grid are identical.
+  bool is_identity() const { return identity_; }
+  /// The interpolation weights of the left neighbours.
+  const eigen::Vector<Scalar> &get_weights() const { return weights_; }
+  /// The cubic interpolation stencils.
+  const eigen::MatrixFixedRows<Scalar, 4> &get_stencils() const {
+    return stencils_;
+  }
+  /// The indices of the left neighbours or the first stencil points.
+  const eigen::Vector<eigen::Index> &get_indices() const { return indices_; }
+
+  /// The maximum number of cached plans.
+  static constexpr size_t max_cache_size = 1024;
+
+ private:
+  using Key = std::tuple<std::vector<Scalar>,
+                         std::vector<Scalar>,
+                         bool,
+                         InterpolationMethod>;
+
+  eigen::Index n_old_;
+  InterpolationMethod method_;
+  bool identity_;
+  eigen::Vector<Scalar> weights_;
+  eigen::MatrixFixedRows<Scalar, 4> stencils_;
+  eigen::Vector<eigen::Index> indices_;
+
+  inline static std::mutex mutex_;
+  inline static std::map<Key, std::shared_ptr<const InterpolationPlan>> cache_;
 };
 
+template <typename Scalar>
+using InterpolationPlanPtr = std::shared_ptr<const InterpolationPlan<Scalar>>;
 
 /** Regridder for regular grids.
  *
@@ -566,7 +1295,7 @@ class RegularRegridder {
               input_dimensions.end(),
               output_dimensions.begin());
     for (eigen::Index i = 0; i < n_dimensions; ++i) {
-      output_dimensions[dimensions_[i]] = new_grids_[i].size();
+      output_dimensions[dimensions_[i]] = plans_[i]->get_n_new();
     }
     return output_dimensions;
   }
@@ -610,24 +1339,64 @@ class RegularRegridder {
     return indices;
   }
 
+  /** Set number of threads to use for regridding.
+   *
+   * The setting is shared by all regridders. The output of each
+   * interpolation step is partitioned over the dimensions preceding the
+   * regridded axis and the output slices along it, so that the results
+   * don't depend on the number of threads. Has no effect if the library
+   * was built without OpenMP support.
+   *
+   * @param n_threads The number of threads. Values smaller than one
+   * select the number of threads reported by OpenMP.
+   */
+  static void set_n_threads(eigen::Index n_threads) {
+#ifdef _OPENMP
+    if (n_threads < 1) {
+      n_threads = omp_get_max_threads();
+    }
+    detail::regridder_n_threads.store(n_threads);
+#else
+    (void) n_threads;
+#endif
+  }
+
+  /// The number of threads used for regridding.
+  static eigen::Index get_n_threads() {
+    return detail::regridder_n_threads.load();
+  }
+
   /** Sets up the regridder for given grids.
+   *
+   * The interpolation weights are obtained from the cache of
+   * interpolation plans.
+   *
    * @param old_grids std::vector containing the old grids, which should be
    * regridded.
    * @param new_grids std::vector containing the new grids
-   * @param dimensions Vector containing the tensor dimensions to which the
-   * given grids correspond.
+   * @param extrapolate Whether to extrapolate outside of the old grids.
+   * @param method The interpolation method.
    */
-  RegularRegridder(std::array<eigen::Vector<Scalar>, n_dimensions> old_grids,
-                   std::array<eigen::Vector<Scalar>, n_dimensions> new_grids,
-                   bool extrapolate=false)
-      : old_grids_(old_grids), new_grids_(new_grids) {
+  RegularRegridder(const std::array<eigen::Vector<Scalar>, n_dimensions> &old_grids,
+                   const std::array<eigen::Vector<Scalar>, n_dimensions> &new_grids,
+                   bool extrapolate=false,
+                   InterpolationMethod method=InterpolationMethod::Linear) {
     for (size_t i = 0; i < dimensions_.size(); ++i) {
-      auto ws = detail::calculate_weights<Scalar>(old_grids_[i],
-                                                  new_grids_[i],
-                                                  extrapolate);
-      weights_[i] = std::get<0>(ws);
-      indices_[i] = std::get<1>(ws);
+      plans_[i] = InterpolationPlan<Scalar>::get(old_grids[i],
+                                                 new_grids[i],
+                                                 extrapolate,
+                                                 method);
     }
+    set_axis_order();
+  }
+
+  /** Sets up the regridder for precomputed interpolation plans.
+   * @param plans The interpolation plans for the regridded dimensions.
+   */
+  RegularRegridder(
+      const std::array<InterpolationPlanPtr<Scalar>, n_dimensions> &plans)
+      : plans_(plans) {
+    set_axis_order();
   }
 
   /** Regrid tensor.
@@ -638,19 +1407,17 @@ class RegularRegridder {
   Tensor regrid(const Tensor &input) {
     constexpr int rank = Tensor::NumIndices;
     eigen::Tensor<typename Tensor::Scalar, rank> output{get_output_dimensions(input)};
-
-    using IndexArray = std::array<Eigen::DenseIndex, rank>;
-    auto generator = [this, &input](const IndexArray &coordinates) {
-        return RegridImpl<0, Axes ...>::compute(input,
-                                                coordinates,
-                                                this->weights_,
-                                                this->indices_);
-    };
-
-    return output.generate(generator);
+    regrid(output, input);
+    return output;
   }
 
   /** Regrid tensor.
+   *
+   * The regridding is separable: the tensor is interpolated along one axis
+   * at a time, starting with the axes that reduce the size of the
+   * intermediate results the most. Axes whose old and new grids are
+   * identical are skipped.
+   *
    * @param output The tensor to hold the result.
    * @param input The tensor to regrid.
    * @return The regridded tensor.
@@ -658,30 +1425,344 @@ class RegularRegridder {
   // pxx :: hide
   template <typename TensorOut, typename TensorIn>
     void regrid(TensorOut &output, TensorIn &input) {
+    using Coefficient = typename TensorOut::Scalar;
     constexpr int rank = TensorOut::NumIndices;
 
-    using IndexArray = std::array<Eigen::DenseIndex, rank>;
-    auto generator = [this, &input](const IndexArray &coordinates) {
-        return RegridImpl<0, Axes ...>::compute(input,
-                                                coordinates,
-                                                this->weights_,
-                                                this->indices_);
-    };
+    std::array<eigen::Index, rank> dimensions;
+    for (int i = 0; i < rank; ++i) {
+      dimensions[i] = input.dimension(i);
+    }
 
-    output = output.generate(generator);
+    eigen::Index n_threads = detail::regridder_n_threads.load();
+    if (n_active_ == 0) {
+      if (output.data() != input.data()) {
+        std::copy(input.data(), input.data() + input.size(), output.data());
+      }
+      return;
+    }
+
+    std::array<std::vector<Coefficient>, 2> buffers;
+    const Coefficient *source = input.data();
+    for (eigen::Index i = 0; i < n_active_; ++i) {
+      auto grid_index = axis_order_[i];
+      auto axis = dimensions_[grid_index];
+      eigen::Index n_outer = 1;
+      for (int j = 0; j < axis; ++j) {
+        n_outer *= dimensions[j];
+      }
+      eigen::Index n_inner = 1;
+      for (int j = axis + 1; j < rank; ++j) {
+        n_inner *= dimensions[j];
+      }
+      const auto &plan = *plans_[grid_index];
+      eigen::Index n_out = plan.get_n_new();
+
+      Coefficient *destination = output.data();
+      if (i < n_active_ - 1) {
+        auto &buffer = buffers[i % 2];
+        buffer.resize(n_outer * n_out * n_inner);
+        destination = buffer.data();
+      }
+      if (plan.get_method() == InterpolationMethod::Cubic) {
+        detail::regrid_axis_cubic(destination,
+                                  source,
+                                  n_outer,
+                                  dimensions[axis],
+                                  n_inner,
+                                  plan.get_stencils(),
+                                  plan.get_indices(),
+                                  n_threads);
+      } else {
+        detail::regrid_axis(destination,
+                            source,
+                            n_outer,
+                            dimensions[axis],
+                            n_inner,
+                            plan.get_weights(),
+                            plan.get_indices(),
+                            n_threads);
+      }
+      dimensions[axis] = n_out;
+      source = destination;
+    }
   }
 
  protected:
+  // Regrid axes that shrink the data first to keep intermediate
+  // results small. Identity axes are moved to the end and not regridded.
+  void set_axis_order() {
+    n_active_ = 0;
+    for (eigen::Index i = 0; i < n_dimensions; ++i) {
+      if (!plans_[i]->is_identity()) {
+        axis_order_[n_active_] = i;
+        ++n_active_;
+      }
+    }
+    for (eigen::Index i = 0, j = n_active_; i < n_dimensions; ++i) {
+      if (plans_[i]->is_identity()) {
+        axis_order_[j] = i;
+        ++j;
+      }
+    }
+    auto ratio = [this](eigen::Index i) {
+      return static_cast<double>(plans_[i]->get_n_new()) /
+             std::max<eigen::Index>(plans_[i]->get_n_old(), 1);
+    };
+    std::stable_sort(axis_order_.begin(),
+                     axis_order_.begin() + n_active_,
+                     [&ratio](eigen::Index i, eigen::Index j) {
+                       return ratio(i) < ratio(j);
+                     });
+  }
 
-
-  std::array<eigen::Vector<Scalar>, n_dimensions> old_grids_;
-  std::array<eigen::Vector<Scalar>, n_dimensions> new_grids_;
-  std::array<eigen::Vector<Scalar>, n_dimensions> weights_;
-  std::array<eigen::Vector<eigen::Index>, n_dimensions> indices_;
+  std::array<InterpolationPlanPtr<Scalar>, n_dimensions> plans_;
+  std::array<eigen::Index, n_dimensions> axis_order_;
+  eigen::Index n_active_ = 0;
   static constexpr std::array<int, n_dimensions> dimensions_{Axes ...};
 
 };
 
+////////////////////////////////////////////////////////////////////////////////
+// Conservative regridding
+////////////////////////////////////////////////////////////////////////////////
+
+/** Conservative regridder.
+ *
+ * Remaps data along a single tensor axis by averaging the piecewise linear
+ * interpolant of the input over the cells of the new grid. The cell
+ * boundaries are the midpoints between the points of the new grid and the
+ * given lower and upper limits. Since the average over each cell is
+ * preserved, the integral of the data over the grid range is preserved
+ * as well. The regridder works for both up- and down-sampling.
+ *
+ * The remapping is linear and stored as a sparse matrix with one row for
+ * each point of the new grid. Regridders obtained using get(...) are cached
+ * by the contents of the grids and the limits.
+ *
+ * @tparam Scalar The floating point type used to represent the grids.
+ */
+template <typename Scalar>
+class ConservativeRegridder {
+ public:
+  using SparseMatrix = Eigen::SparseMatrix<Scalar, Eigen::RowMajor, eigen::Index>;
+
+  /** Create conservative regridder.
+   * @param old_grid The grid to regrid from.
+   * @param new_grid The grid to regrid to.
+   * @param lower_limit The lower boundary of the first cell of the new grid.
+   * @param upper_limit The upper boundary of the last cell of the new grid.
+   */
+  ConservativeRegridder(const eigen::Vector<Scalar> &old_grid,
+                        const eigen::Vector<Scalar> &new_grid,
+                        Scalar lower_limit,
+                        Scalar upper_limit)
+      : matrix_(new_grid.size(), old_grid.size()) {
+    using eigen::Index;
+    Index n_old = old_grid.size();
+    Index n_new = new_grid.size();
+
+    // Calculate cell boundaries.
+    eigen::Vector<Scalar> limits(n_new + 1);
+    limits[0] = lower_limit;
+    limits[n_new] = upper_limit;
+    for (Index i = 1; i < n_new; ++i) {
+      limits[i] = 0.5 * (new_grid[i - 1] + new_grid[i]);
+    }
+    eigen::Vector<Scalar> weights;
+    eigen::Vector<Index> indices;
+    std::tie(weights, indices) =
+        detail::calculate_weights<Scalar>(old_grid, limits, false);
+
+    std::vector<Eigen::Triplet<Scalar, Index>> triplets;
+    triplets.reserve(2 * (n_old + 2 * n_new));
+
+    // Adds c times the interpolated value at cell boundary j to row i.
+    auto add_boundary = [&](Index i, Index j, Scalar c) {
+      triplets.emplace_back(i, indices[j], c * weights[j]);
+      if ((weights[j] != 1.0) && (indices[j] + 1 < n_old)) {
+        triplets.emplace_back(i, indices[j] + 1, c * (1.0 - weights[j]));
+      }
+    };
+
+    // Integrate the interpolant over each cell using the trapezoidal rule
+    // on the cell boundaries and the old grid points within the cell.
+    Index k = 0;
+    for (Index i = 0; i < n_new; ++i) {
+      Scalar dx = limits[i + 1] - limits[i];
+      if (dx == 0.0) {
+        continue;
+      }
+      Scalar scale = 1.0 / dx;
+      while ((k < n_old) && (old_grid[k] <= limits[i])) {
+        ++k;
+      }
+
+      Scalar left = limits[i];
+      Index left_index = -1;
+      auto add_segment = [&](Scalar right, Index right_index) {
+        Scalar c = 0.5 * (right - left) * scale;
+        if (left_index < 0) {
+          add_boundary(i, i, c);
+        } else {
+          triplets.emplace_back(i, left_index, c);
+        }
+        if (right_index < 0) {
+          add_boundary(i, i + 1, c);
+        } else {
+          triplets.emplace_back(i, right_index, c);
+        }
+        left = right;
+        left_index = right_index;
+      };
+      while ((k < n_old) && (old_grid[k] < limits[i + 1])) {
+        add_segment(old_grid[k], k);
+        ++k;
+      }
+      add_segment(limits[i + 1], -1);
+    }
+    matrix_.setFromTriplets(triplets.begin(), triplets.end());
+    matrix_.makeCompressed();
+  }
+
+  /** Get cached conservative regridder.
+   * @param old_grid The grid to regrid from.
+   * @param new_grid The grid to regrid to.
+   * @param lower_limit The lower boundary of the first cell of the new grid.
+   * @param upper_limit The upper boundary of the last cell of the new grid.
+   * @return Shared pointer to the regridder for the given grids.
+   */
+  static std::shared_ptr<const ConservativeRegridder> get(
+      const eigen::Vector<Scalar> &old_grid,
+      const eigen::Vector<Scalar> &new_grid,
+      Scalar lower_limit,
+      Scalar upper_limit) {
+    Key key{std::vector<Scalar>(old_grid.begin(), old_grid.end()),
+            std::vector<Scalar>(new_grid.begin(), new_grid.end()),
+            lower_limit,
+            upper_limit};
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto found = cache_.find(key);
+      if (found != cache_.end()) {
+        return found->second;
+      }
+    }
+    auto regridder = std::make_shared<const ConservativeRegridder>(
+        old_grid, new_grid, lower_limit, upper_limit);
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (cache_.size() >= max_cache_size) {
+      cache_.clear();
+    }
+    cache_.emplace(std::move(key), regridder);
+    return regridder;
+  }
+
+  /// Remove all regridders from the cache.
+  static void clear_cache() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    cache_.clear();
+  }
+
+  /// The size of the grid to regrid from.
+  eigen::Index get_n_old() const { return matrix_.cols(); }
+  /// The size of the grid to regrid to.
+  eigen::Index get_n_new() const { return matrix_.rows(); }
+  /// The sparse remapping matrix.
+  const SparseMatrix &get_matrix() const { return matrix_; }
+
+  /** Regrid tensor along given axis.
+   * @param input The tensor to regrid.
+   * @param axis The axis along which to regrid.
+   * @return The regridded tensor.
+   */
+  template <typename TensorType>
+  eigen::Tensor<typename TensorType::Scalar, TensorType::NumIndices> regrid(
+      const TensorType &input,
+      eigen::Index axis) const {
+    constexpr int rank = TensorType::NumIndices;
+    std::array<eigen::Index, rank> dimensions = input.dimensions();
+    eigen::Index n_outer = 1;
+    for (eigen::Index i = 0; i < axis; ++i) {
+      n_outer *= dimensions[i];
+    }
+    eigen::Index n_inner = 1;
+    for (eigen::Index i = axis + 1; i < rank; ++i) {
+      n_inner *= dimensions[i];
+    }
+    dimensions[axis] = get_n_new();
+    eigen::Tensor<typename TensorType::Scalar, rank> output{dimensions};
+    regrid(output.data(), input.data(), n_outer, n_inner);
+    return output;
+  }
+
+  /** Regrid contiguous data along a single axis.
+   *
+   * Input and output are viewed as rank-3 tensors of shape
+   * (n_outer, n_old, n_inner) and (n_outer, n_new, n_inner), respectively.
+   *
+   * @param output Pointer to the output data.
+   * @param input Pointer to the input data.
+   * @param n_outer The product of the dimensions before the axis.
+   * @param n_inner The product of the dimensions after the axis.
+   */
+  template <typename Coefficient>
+  void regrid(Coefficient *output,
+              const Coefficient *input,
+              eigen::Index n_outer,
+              eigen::Index n_inner) const {
+    using ArrayMap = Eigen::Map<Eigen::Array<Coefficient, Eigen::Dynamic, 1>>;
+    using ConstArrayMap =
+        Eigen::Map<const Eigen::Array<Coefficient, Eigen::Dynamic, 1>>;
+    eigen::Index n_old = get_n_old();
+    eigen::Index n_new = get_n_new();
+    [[maybe_unused]] eigen::Index n_threads =
+        detail::regridder_n_threads.load();
+#ifdef _OPENMP
+#pragma omp parallel for collapse(2) num_threads(n_threads) if (n_threads > 1)
+#endif
+    for (eigen::Index i = 0; i < n_outer; ++i) {
+      for (eigen::Index j = 0; j < n_new; ++j) {
+        const Coefficient *source = input + i * n_old * n_inner;
+        ArrayMap result(output + (i * n_new + j) * n_inner, n_inner);
+        result.setZero();
+        for (typename SparseMatrix::InnerIterator it(matrix_, j); it; ++it) {
+          result += it.value() *
+                    ConstArrayMap(source + it.col() * n_inner, n_inner);
+        }
+      }
+    }
+  }
+
+  /// The maximum number of cached regridders.
+  static constexpr size_t max_cache_size = 1024;
+
+ private:
+  using Key = std::tuple<std::vector<Scalar>, std::vector<Scalar>, Scalar, Scalar>;
+
+  SparseMatrix matrix_;
+
+  inline static std::mutex mutex_;
+  inline static std::map<Key, std::shared_ptr<const ConservativeRegridder>> cache_;
+};
+
+template <typename Scalar>
+using ConservativeRegridderPtr =
+    std::shared_ptr<const ConservativeRegridder<Scalar>>;
+
+/** Downsample tensor dimension by averaging.
+ *
+ * Averages the linearly interpolated input over cells centered on the
+ * points of the output grid using a cached ConservativeRegridder.
+ *
+ * @tparam rank The dimension to downsample.
+ * @param input The tensor to downsample.
+ * @param input_grid The grid corresponding to the given dimension of the
+ * input.
+ * @param output_grid The grid to downsample the dimension to.
+ * @param minimum_value The lower boundary of the first output cell.
+ * @param maximum_value The upper boundary of the last output cell.
+ * @return The downsampled tensor.
+ */
 // pxx :: export
 // pxx :: instance(["1", "Eigen::Tensor<float, 2, Eigen::RowMajor>", "float"])
 // pxx :: instance(["1", "Eigen::Tensor<double, 2, Eigen::RowMajor>", "double"])
@@ -692,90 +1773,11 @@ eigen::Tensor<typename TensorType::Scalar, TensorType::NumIndices> downsample_di
     const eigen::Vector<Scalar>& output_grid,
     Scalar minimum_value,
     Scalar maximum_value) {
-  using eigen::Index;
-  using eigen::Tensor;
-  using eigen::Vector;
-
-  // Calculate integration limits.
-  Index n = output_grid.size();
-  Vector<Scalar> limits(n + 1);
-  limits[0] = minimum_value;
-  limits[n] = maximum_value;
-  for (Index i = 1; i < n; ++i) {
-    limits[i] = 0.5 * (output_grid[i - 1] + output_grid[i]);
-  }
-
-  // Interpolate input to boundary values.
-  auto regridder = RegularRegridder<Scalar, rank>({input_grid}, {limits});
-  auto regridded = regridder.regrid(input);
-
-  // Prepare output
-  auto result_dimensions = input.dimensions();
-  result_dimensions[rank] = output_grid.size();
-  auto result = Tensor<typename TensorType::Scalar, TensorType::NumIndices>{result_dimensions};
-
-  // Prepare integral value
-  std::array<Index, TensorType::NumIndices - 1> integral_dimensions;
-  Index dimension_index = 0;
-  for (Index i = 0; i < TensorType::NumIndices; ++i) {
-    if (i != rank) {
-      integral_dimensions[dimension_index] = input.dimension(i);
-      dimension_index += 1;
-    }
-  }
-  auto integral =
-      Tensor<typename TensorType::Scalar, TensorType::NumIndices - 1>(integral_dimensions);
-
-  Index input_index = 0;
-
-  for (Index i = 0; i < n; ++i) {
-    Scalar left_limit = limits[i];
-    Scalar right_limit = limits[i + 1];
-
-    Scalar left = left_limit;
-    Scalar right = left_limit;
-    Scalar dx = 0.0;
-
-    auto left_value = regridded.template chip<rank>(i);
-    auto right_value = left_value;
-
-    integral = integral.setZero();
-
-    while ((input_index < input_grid.size()) && (input_grid[input_index] < right_limit)) {
-      right_value = input.template chip<rank>(input_index);
-      right = input_grid[input_index];
-      integral += 0.5 * (right - left) * (left_value + right_value);
-      dx += (right - left);
-      left = right;
-      left_value = right_value;
-      input_index += 1;
-    }
-
-    right_value = regridded.template chip<rank>(i + 1);
-    right = right_limit;
-    dx += (right - left);
-    integral += 0.5 * (right - left) * (left_value + right_value);
-    if (i == 0) {
-      if (n == 1) {
-        dx = limits[1] - limits[0];
-      } else {
-        dx = output_grid[0] - limits[0] +
-             0.5 * (output_grid[1] - output_grid[0]);
-      }
-    } else if (i < n - 1) {
-      dx = 0.5 * (output_grid[i + 1] - output_grid[i - 1]);
-    } else {
-      dx = limits[i + 1] - output_grid[i] +
-           0.5 * (output_grid[i] - output_grid[i - 1]);
-    }
-    if (dx != 0.0) {
-      result.template chip<rank>(i) = 1.0 / dx * integral;
-    } else {
-      result.template chip<rank>(i) = integral.setZero();
-    }
-  }
-
-  return result;
+  auto regridder = ConservativeRegridder<Scalar>::get(input_grid,
+                                                      output_grid,
+                                                      minimum_value,
+                                                      maximum_value);
+  return regridder->regrid(input, rank);
 }
 
 }  // Namespace scattering
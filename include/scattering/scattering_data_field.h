@@ -27,7 +27,9 @@
 #include <scattering/sht.h>
 #include <scattering/utils/array.h>
 
+#include <algorithm>
 #include <cassert>
+#include <limits>
 #include <memory>
 
 namespace scattering {
@@ -82,6 +84,80 @@ class ScatteringDataFieldBase {
         n_lon_scat_(n_lon_scat),
         n_lat_scat_(n_lat_scat) {}
 
+  /** Interpolate data to a single frequency and temperature.
+   *
+   * Computes the linear combination of the at most four frequency-
+   * temperature slices of the data that surround the given point and
+   * writes it directly into the output buffer.
+   *
+   * @param output Pointer to the buffer to write the result to. Must hold
+   * slice_size elements.
+   * @param data Pointer to the data, whose two leading dimensions are the
+   * frequency and temperature dimensions.
+   * @param f_grid The frequency grid of the data.
+   * @param t_grid The temperature grid of the data.
+   * @param frequency The frequency to interpolate the data to.
+   * @param temperature The temperature to interpolate the data to.
+   * @param slice_size The number of elements of a single
+   * frequency-temperature slice of the data.
+   * @param extrapolate Whether to extrapolate linearly along temperatures.
+   */
+  template <typename Coefficient, typename Scalar>
+  static void interpolate_point(Coefficient *output,
+                                const Coefficient *data,
+                                const eigen::Vector<Scalar> &f_grid,
+                                const eigen::Vector<Scalar> &t_grid,
+                                Scalar frequency,
+                                Scalar temperature,
+                                Index slice_size,
+                                bool extrapolate) {
+    using ArrayMap = Eigen::Map<Eigen::Array<Coefficient, Eigen::Dynamic, 1>>;
+    using ConstArrayMap =
+        Eigen::Map<const Eigen::Array<Coefficient, Eigen::Dynamic, 1>>;
+
+    eigen::VectorFixedSize<Scalar, 1> weights_f{1.0}, weights_t{1.0};
+    eigen::VectorFixedSize<Index, 1> indices_f{0}, indices_t{0};
+    if (f_grid.size() > 1) {
+      detail::calculate_weights(weights_f,
+                                indices_f,
+                                f_grid,
+                                eigen::VectorFixedSize<Scalar, 1>{frequency});
+    }
+    if (t_grid.size() > 1) {
+      detail::calculate_weights(weights_t,
+                                indices_t,
+                                t_grid,
+                                eigen::VectorFixedSize<Scalar, 1>{temperature},
+                                extrapolate);
+    }
+
+    Index n_temps = t_grid.size();
+    ArrayMap result(output, slice_size);
+    result.setZero();
+    for (Index i = 0; i < 2; ++i) {
+      Scalar w_f = (i == 0) ? weights_f[0] : 1.0 - weights_f[0];
+      if (w_f == 0.0) {
+        continue;
+      }
+      for (Index j = 0; j < 2; ++j) {
+        Scalar w_t = (j == 0) ? weights_t[0] : 1.0 - weights_t[0];
+        if (w_t == 0.0) {
+          continue;
+        }
+        Index offset = (indices_f[0] + i) * n_temps + indices_t[0] + j;
+        result += (w_f * w_t) *
+                  ConstArrayMap(data + offset * slice_size, slice_size);
+      }
+    }
+  }
+
+  /// Whether two grids are the same object or contain the same values.
+  template <typename VectorPtr>
+  static bool is_same_grid(const VectorPtr &grid, const VectorPtr &other) {
+    return (grid == other) ||
+           ((grid->size() == other->size()) && (*grid == *other));
+  }
+
  protected:
   Index n_freqs_;
   Index n_temps_;
@@ -97,6 +173,7 @@ class ScatteringDataFieldBase {
 ////////////////////////////////////////////////////////////////////////////////
 // pxx :: export
 // pxx :: instance(["double"])
+// pxx :: instance("ScatteringDataFieldGriddedFloat", ["float"])
 /** Gridded scattering data field.
  *
  * Holds scattering data in gridded format. The data is in this case given
@@ -291,17 +368,17 @@ class ScatteringDataFieldGridded : public ScatteringDataFieldBase {
       return sht::SHT::get_params(n_lon_scat_, n_lat_scat_);
   }
   /// The frequency grid.
-  const eigen::Vector<double> &get_f_grid() const { return *f_grid_; }
+  const Vector &get_f_grid() const { return *f_grid_; }
   /// The temperature grid.
-  const eigen::Vector<double>& get_t_grid() const { return *t_grid_; }
+  const Vector &get_t_grid() const { return *t_grid_; }
   /// The incoming-angle longitude grid.
-  eigen::Vector<double> get_lon_inc() const { return *lon_inc_; }
+  Vector get_lon_inc() const { return *lon_inc_; }
   /// The incoming-angle latitude grid.
-  eigen::Vector<double> get_lat_inc() const { return *lat_inc_; }
+  Vector get_lat_inc() const { return *lat_inc_; }
   //// The scattering-angle longitude grid.
-  eigen::Vector<double> get_lon_scat() const { return *lon_scat_; }
+  Vector get_lon_scat() const { return *lon_scat_; }
   //// The scattering-angle latitude grid.
-  eigen::Vector<double> get_lat_scat() const { return *lat_scat_; }
+  Vector get_lat_scat() const { return *lat_scat_; }
 
   /// Deep copy of the scattering data.
   ScatteringDataFieldGridded copy() const {
@@ -359,8 +436,23 @@ class ScatteringDataFieldGridded : public ScatteringDataFieldBase {
    */
   ScatteringDataFieldGridded interpolate_frequency(
       std::shared_ptr<Vector> frequencies) const {
-    using Regridder = RegularRegridder<Scalar, 0>;
-    Regridder regridder({*f_grid_}, {*frequencies});
+    return interpolate_frequency(
+        frequencies,
+        InterpolationPlan<Scalar>::get(*f_grid_, *frequencies));
+  }
+
+  // pxx :: hide
+  /** Linear interpolation along frequency dimension using precomputed plan.
+   * @param frequencies The frequencies to which to interpolate the data.
+   * @param plan Interpolation plan from the frequency grid of this object
+   * to the given frequencies.
+   * @return New ScatteringDataFieldGridded with the data interpolated
+   * to the given frequencies.
+   */
+  ScatteringDataFieldGridded interpolate_frequency(
+      std::shared_ptr<Vector> frequencies,
+      InterpolationPlanPtr<Scalar> plan) const {
+    RegularRegridder<Scalar, 0> regridder({plan});
     auto dimensions_new = data_->dimensions();
     auto data_interp = regridder.regrid(*data_);
     dimensions_new[0] = frequencies->size();
@@ -393,8 +485,23 @@ class ScatteringDataFieldGridded : public ScatteringDataFieldBase {
   ScatteringDataFieldGridded interpolate_temperature(
       std::shared_ptr<Vector> temperatures,
       bool extrapolate=false) const {
-    using Regridder = RegularRegridder<Scalar, 1>;
-    Regridder regridder({*t_grid_}, {*temperatures}, extrapolate);
+    return interpolate_temperature(
+        temperatures,
+        InterpolationPlan<Scalar>::get(*t_grid_, *temperatures, extrapolate));
+  }
+
+  // pxx :: hide
+  /** Linear interpolation along temperature dimension using precomputed plan.
+   * @param temperatures The temperatures to which to interpolate the data.
+   * @param plan Interpolation plan from the temperature grid of this object
+   * to the given temperatures.
+   * @return New ScatteringDataFieldGridded with the data interpolated
+   * to the given temperatures.
+   */
+  ScatteringDataFieldGridded interpolate_temperature(
+      std::shared_ptr<Vector> temperatures,
+      InterpolationPlanPtr<Scalar> plan) const {
+    RegularRegridder<Scalar, 1> regridder({plan});
     auto dimensions_new = data_->dimensions();
     auto data_interp = regridder.regrid(*data_);
     dimensions_new[1] = temperatures->size();
@@ -419,6 +526,61 @@ class ScatteringDataFieldGridded : public ScatteringDataFieldBase {
     return interpolate_temperature(std::make_shared<Vector>(temperatures), extrapolate);
   }
 
+  /** Number of elements of the data at a single frequency and temperature.
+   *
+   * This is the size of the buffer required by interpolate_point(...).
+   */
+  Index get_point_size() const { return data_->size() / (n_freqs_ * n_temps_); }
+
+  // pxx :: hide
+  /** Interpolate data to a single frequency and temperature.
+   *
+   * Fused linear interpolation along frequency and temperature that writes
+   * the result directly into a caller-supplied buffer without allocating
+   * intermediate tensors. The buffer is filled with the data tensor
+   * layout with the frequency and temperature dimensions removed.
+   *
+   * @param output Pointer to a buffer that can hold get_point_size()
+   * elements.
+   * @param frequency The frequency to interpolate the data to.
+   * @param temperature The temperature to interpolate the data to.
+   * @param extrapolate Whether to extrapolate linearly along temperatures.
+   */
+  void interpolate_point(Coefficient *output,
+                         Scalar frequency,
+                         Scalar temperature,
+                         bool extrapolate = false) const {
+    ScatteringDataFieldBase::interpolate_point(output,
+                                              data_->data(),
+                                              *f_grid_,
+                                              *t_grid_,
+                                              frequency,
+                                              temperature,
+                                              get_point_size(),
+                                              extrapolate);
+  }
+
+  /** Interpolate data to a single frequency and temperature.
+   * @param frequency The frequency to interpolate the data to.
+   * @param temperature The temperature to interpolate the data to.
+   * @param extrapolate Whether to extrapolate linearly along temperatures.
+   * @return Tensor containing the interpolated data with the frequency and
+   * temperature dimensions removed.
+   */
+  eigen::Tensor<Coefficient, DataTensor::NumIndices - 2> interpolate_point(
+      Scalar frequency,
+      Scalar temperature,
+      bool extrapolate = false) const {
+    constexpr int rank_out = DataTensor::NumIndices - 2;
+    std::array<Index, rank_out> dimensions;
+    for (int i = 0; i < rank_out; ++i) {
+      dimensions[i] = data_->dimension(i + 2);
+    }
+    eigen::Tensor<Coefficient, rank_out> result{dimensions};
+    interpolate_point(result.data(), frequency, temperature, extrapolate);
+    return result;
+  }
+
   // pxx :: hide
   /** Linear interpolation along angles.
    * @param lon_inc_new The incoming-angle longitude grid to which to interpolate
@@ -485,7 +647,7 @@ class ScatteringDataFieldGridded : public ScatteringDataFieldBase {
   ScatteringDataFieldGridded downsample_scattering_angles(VectorPtr lon_scat_new,
                                                           LatitudeGridPtr lat_scat_new,
                                                           bool interpolate_latitudes=true) const {
-      auto data_downsampled = downsample_dimension<4>(*data_, *lon_scat_, *lon_scat_new, 0.0, 2.0 * M_PI);
+      auto data_downsampled = downsample_dimension<4>(*data_, *lon_scat_, *lon_scat_new, Scalar(0.0), Scalar(2.0 * M_PI));
       Vector colatitudes = -lat_scat_->array().cos();
       Vector colatitudes_new = -lat_scat_new->array().cos();
 
@@ -494,7 +656,7 @@ class ScatteringDataFieldGridded : public ScatteringDataFieldBase {
           Regridder regridder({*lat_scat_}, {*lat_scat_new}, false);
           data_downsampled = regridder.regrid(data_downsampled);
       } else {
-          data_downsampled = downsample_dimension<5>(data_downsampled, colatitudes, colatitudes_new, -1.0, 1.0);
+          data_downsampled = downsample_dimension<5>(data_downsampled, colatitudes, colatitudes_new, Scalar(-1.0), Scalar(1.0));
       }
 
       return ScatteringDataFieldGridded(f_grid_,
@@ -529,7 +691,7 @@ class ScatteringDataFieldGridded : public ScatteringDataFieldBase {
    * of the scattering angle downsampled to the given grid.
    */
   ScatteringDataFieldGridded downsample_lon_scat(VectorPtr lon_scat_new) const {
-      auto data_downsampled = downsample_dimension<4>(*data_, *lon_scat_, *lon_scat_new, 0.0, 2.0 * M_PI);
+      auto data_downsampled = downsample_dimension<4>(*data_, *lon_scat_, *lon_scat_new, Scalar(0.0), Scalar(2.0 * M_PI));
       return ScatteringDataFieldGridded(f_grid_,
                                         t_grid_,
                                         lon_inc_,
@@ -618,13 +780,23 @@ class ScatteringDataFieldGridded : public ScatteringDataFieldBase {
   /** Accumulate scattering data into this object.
    *
    * Regrids the given scattering data field and accumulates its interpolated
-   * data tensor into this object's data tensor.
+   * data tensor into this object's data tensor. If all grids are the same,
+   * the data is added directly.
    *
    * @param other The ScatteringDataField to accumulate into this.
    * @return Reference to this object.
    */
   ScatteringDataFieldGridded operator+=(
       const ScatteringDataFieldGridded &other) {
+    if (is_same_grid(f_grid_, other.f_grid_) &&
+        is_same_grid(t_grid_, other.t_grid_) &&
+        is_same_grid(lon_inc_, other.lon_inc_) &&
+        is_same_grid(lat_inc_, other.lat_inc_) &&
+        is_same_grid(lon_scat_, other.lon_scat_) &&
+        is_same_grid(lat_scat_, other.lat_scat_)) {
+      *data_ += *other.data_;
+      return *this;
+    }
     auto regridded = other.regrid(f_grid_,
                                   t_grid_,
                                   lon_inc_,
@@ -698,7 +870,7 @@ class ScatteringDataFieldGridded : public ScatteringDataFieldBase {
    * @return The scattering data field transformed to spectral format.
    */
   ScatteringDataFieldSpectral<Scalar> to_spectral(
-      std::shared_ptr<sht::SHT> sht) const;
+      std::shared_ptr<const sht::SHT> sht) const;
 
   /** Convert gridded data to spectral format.
    * @param l_max The maximum degree l to use in the SH expansion.
@@ -707,8 +879,8 @@ class ScatteringDataFieldGridded : public ScatteringDataFieldBase {
    */
   ScatteringDataFieldSpectral<Scalar> to_spectral(Index l_max,
                                                   Index m_max) const {
-    std::shared_ptr<sht::SHT> sht =
-        std::make_shared<sht::SHT>(l_max, m_max, n_lon_scat_, n_lat_scat_);
+    std::shared_ptr<const sht::SHT> sht =
+        sht::SHTProvider::get(l_max, m_max, n_lon_scat_, n_lat_scat_);
     return to_spectral(sht);
   }
 
@@ -721,8 +893,8 @@ class ScatteringDataFieldGridded : public ScatteringDataFieldBase {
                                                   Index m_max,
                                                   Index n_lon,
                                                   Index n_lat) const {
-      std::shared_ptr<sht::SHT> sht =
-          std::make_shared<sht::SHT>(l_max,
+      std::shared_ptr<const sht::SHT> sht =
+          sht::SHTProvider::get(l_max,
                                      m_max,
                                      n_lon,
                                      n_lat);
@@ -769,6 +941,7 @@ class ScatteringDataFieldGridded : public ScatteringDataFieldBase {
 
 // pxx :: export
 // pxx :: instance(["double"])
+// pxx :: instance("ScatteringDataFieldSpectralFloat", ["float"])
 /** Scattering data in spectral format.
  *
  * Uses a spherical-harmonics expansion to represent the scattering-angle
@@ -805,7 +978,7 @@ class ScatteringDataFieldSpectral : public ScatteringDataFieldBase {
   using Matrix = eigen::Matrix<Scalar>;
   using MatrixMap = eigen::MatrixMap<Scalar>;
   using ConstMatrixMap = eigen::ConstMatrixMap<Scalar>;
-  using ShtPtr = std::shared_ptr<sht::SHT>;
+  using ShtPtr = std::shared_ptr<const sht::SHT>;
 
   template <eigen::Index rank>
   using CmplxTensor = eigen::Tensor<std::complex<Scalar>, rank>;
@@ -877,7 +1050,7 @@ class ScatteringDataFieldSpectral : public ScatteringDataFieldBase {
         t_grid_(std::make_shared<Vector>(t_grid)),
         lon_inc_(std::make_shared<Vector>(lon_inc)),
         lat_inc_(std::make_shared<Vector>(lat_inc)),
-        sht_scat_(std::make_shared<sht::SHT>(sht_scat)),
+        sht_scat_(sht::SHTProvider::get(sht_scat)),
         f_grid_map_(f_grid_->data(), n_freqs_),
         t_grid_map_(t_grid_->data(), n_temps_),
         lon_inc_map_(lon_inc_->data(), n_freqs_),
@@ -909,7 +1082,7 @@ class ScatteringDataFieldSpectral : public ScatteringDataFieldBase {
         t_grid_(std::make_shared<Vector>(t_grid)),
         lon_inc_(std::make_shared<Vector>(lon_inc)),
         lat_inc_(std::make_shared<Vector>(lat_inc)),
-        sht_scat_(std::make_shared<sht::SHT>(sht_scat)),
+        sht_scat_(sht::SHTProvider::get(sht_scat)),
         f_grid_map_(f_grid_->data(), n_freqs_),
         t_grid_map_(t_grid_->data(), n_temps_),
         lon_inc_map_(lon_inc_->data(), n_freqs_),
@@ -955,25 +1128,25 @@ class ScatteringDataFieldSpectral : public ScatteringDataFieldBase {
   std::array<Index, 4> get_sht_inc_params() const {
       return sht::SHT::get_params(n_lon_inc_, n_lat_inc_);
   }
-  const eigen::Vector<double>& get_f_grid() const { return *f_grid_; }
+  const Vector &get_f_grid() const { return *f_grid_; }
   /// The temperature grid.
-  const eigen::Vector<double>& get_t_grid() const { return *t_grid_; }
+  const Vector &get_t_grid() const { return *t_grid_; }
   /// The incoming-angle longitude grid.
-  eigen::Vector<double> get_lon_inc() const { return *lon_inc_; }
+  Vector get_lon_inc() const { return *lon_inc_; }
   /// The incoming-angle latitude grid.
-  eigen::Vector<double> get_lat_inc() const { return *lat_inc_; }
+  Vector get_lat_inc() const { return *lat_inc_; }
   /// The scattering-angle longitude grid.
-  eigen::Vector<double> get_lon_scat() const {
-    return sht_scat_->get_longitude_grid();
+  Vector get_lon_scat() const {
+    return sht_scat_->get_longitude_grid().cast<Scalar>();
   }
   /// The scattering-angle latitude grid.
-  eigen::Vector<double> get_lat_scat() const {
-    return sht_scat_->get_latitude_grid();
+  Vector get_lat_scat() const {
+    return sht_scat_->get_latitude_grid().cast<Scalar>();
   }
 
   /// The SHT object used to transform the data along the scattering
   /// angle.
-  sht::SHT &get_sht_scat() const { return *sht_scat_; }
+  const sht::SHT &get_sht_scat() const { return *sht_scat_; }
 
   /// The raw scattering data.
   const DataTensor &get_data() const { return *data_; }
@@ -1006,17 +1179,13 @@ class ScatteringDataFieldSpectral : public ScatteringDataFieldBase {
                                               temperature_index};
     std::array<eigen::Index, 2> input_index = {0, 0};
 
-    eigen::IndexArray<3> dimensions_loop = {n_lon_inc_,
-                                            n_lat_inc_,
-                                            data_->dimension(5)};
     auto data_map = eigen::tensor_index(*data_, data_index);
     auto other_data_map = eigen::tensor_index(regridded, input_index);
-    for (eigen::DimensionCounter<3> i{dimensions_loop}; i; ++i) {
-      auto result = eigen::get_subvector<2>(data_map, i.coordinates);
-      auto in_l = eigen::get_subvector<2>(data_map, i.coordinates);
-      auto in_r = eigen::get_subvector<2>(other_data_map, i.coordinates);
-      result = sht::SHT::add_coeffs(*sht_scat_, in_l, *other.sht_scat_, in_r);
-    }
+    auto index_map = sht::SpectralIndexMap::get(*other.sht_scat_, *sht_scat_);
+    index_map->accumulate(data_map.data(),
+                          other_data_map.data(),
+                          n_lon_inc_ * n_lat_inc_,
+                          data_->dimension(5));
   }
 
   // pxx :: hide
@@ -1027,8 +1196,23 @@ class ScatteringDataFieldSpectral : public ScatteringDataFieldBase {
    */
   ScatteringDataFieldSpectral interpolate_frequency(
       std::shared_ptr<Vector> frequencies) const {
-    using Regridder = RegularRegridder<Scalar, 0>;
-    Regridder regridder({*f_grid_}, {*frequencies});
+    return interpolate_frequency(
+        frequencies,
+        InterpolationPlan<Scalar>::get(*f_grid_, *frequencies));
+  }
+
+  // pxx :: hide
+  /** Linear interpolation along frequency dimension using precomputed plan.
+   * @param frequencies The frequencies to which to interpolate the data.
+   * @param plan Interpolation plan from the frequency grid of this object
+   * to the given frequencies.
+   * @return New ScatteringDataFieldSpectral with the data interpolated
+   * to the given frequencies.
+   */
+  ScatteringDataFieldSpectral interpolate_frequency(
+      std::shared_ptr<Vector> frequencies,
+      InterpolationPlanPtr<Scalar> plan) const {
+    RegularRegridder<Scalar, 0> regridder({plan});
     auto dimensions_new = data_->dimensions();
     auto data_interp = regridder.regrid(*data_);
     dimensions_new[0] = frequencies->size();
@@ -1060,8 +1244,23 @@ class ScatteringDataFieldSpectral : public ScatteringDataFieldBase {
   ScatteringDataFieldSpectral interpolate_temperature(
       std::shared_ptr<Vector> temperatures,
       bool extrapolate=false) const {
-    using Regridder = RegularRegridder<Scalar, 1>;
-    Regridder regridder({*t_grid_}, {*temperatures}, extrapolate);
+    return interpolate_temperature(
+        temperatures,
+        InterpolationPlan<Scalar>::get(*t_grid_, *temperatures, extrapolate));
+  }
+
+  // pxx :: hide
+  /** Linear interpolation along temperature dimension using precomputed plan.
+   * @param temperatures The temperatures to which to interpolate the data.
+   * @param plan Interpolation plan from the temperature grid of this object
+   * to the given temperatures.
+   * @return New ScatteringDataFieldSpectral with the data interpolated
+   * to the given temperatures.
+   */
+  ScatteringDataFieldSpectral interpolate_temperature(
+      std::shared_ptr<Vector> temperatures,
+      InterpolationPlanPtr<Scalar> plan) const {
+    RegularRegridder<Scalar, 1> regridder({plan});
     auto dimensions_new = data_->dimensions();
     auto data_interp = regridder.regrid(*data_);
     dimensions_new[1] = temperatures->size();
@@ -1086,6 +1285,61 @@ class ScatteringDataFieldSpectral : public ScatteringDataFieldBase {
                                      extrapolate);
   }
 
+  /** Number of elements of the data at a single frequency and temperature.
+   *
+   * This is the size of the buffer required by interpolate_point(...).
+   */
+  Index get_point_size() const { return data_->size() / (n_freqs_ * n_temps_); }
+
+  // pxx :: hide
+  /** Interpolate data to a single frequency and temperature.
+   *
+   * Fused linear interpolation along frequency and temperature that writes
+   * the result directly into a caller-supplied buffer without allocating
+   * intermediate tensors. The buffer is filled with the data tensor
+   * layout with the frequency and temperature dimensions removed.
+   *
+   * @param output Pointer to a buffer that can hold get_point_size()
+   * elements.
+   * @param frequency The frequency to interpolate the data to.
+   * @param temperature The temperature to interpolate the data to.
+   * @param extrapolate Whether to extrapolate linearly along temperatures.
+   */
+  void interpolate_point(Coefficient *output,
+                         Scalar frequency,
+                         Scalar temperature,
+                         bool extrapolate = false) const {
+    ScatteringDataFieldBase::interpolate_point(output,
+                                              data_->data(),
+                                              *f_grid_,
+                                              *t_grid_,
+                                              frequency,
+                                              temperature,
+                                              get_point_size(),
+                                              extrapolate);
+  }
+
+  /** Interpolate data to a single frequency and temperature.
+   * @param frequency The frequency to interpolate the data to.
+   * @param temperature The temperature to interpolate the data to.
+   * @param extrapolate Whether to extrapolate linearly along temperatures.
+   * @return Tensor containing the interpolated data with the frequency and
+   * temperature dimensions removed.
+   */
+  eigen::Tensor<Coefficient, DataTensor::NumIndices - 2> interpolate_point(
+      Scalar frequency,
+      Scalar temperature,
+      bool extrapolate = false) const {
+    constexpr int rank_out = DataTensor::NumIndices - 2;
+    std::array<Index, rank_out> dimensions;
+    for (int i = 0; i < rank_out; ++i) {
+      dimensions[i] = data_->dimension(i + 2);
+    }
+    eigen::Tensor<Coefficient, rank_out> result{dimensions};
+    interpolate_point(result.data(), frequency, temperature, extrapolate);
+    return result;
+  }
+
   // pxx :: hide
   /** Interpolate data along incoming angles.
    * @param lon_inc_new The incoming-angle longitudes to which to interpolate the data.
@@ -1154,7 +1408,33 @@ class ScatteringDataFieldSpectral : public ScatteringDataFieldBase {
    */
   eigen::Tensor<Scalar, 5> integrate_scattering_angles() const {
       eigen::Tensor<std::complex<Scalar>, 5> result = data_->template chip<4>(0);
-      return result.real() * sqrt(4.0 * M_PI);
+      return result.real() * static_cast<Scalar>(sqrt(4.0 * M_PI));
+  }
+
+  /** Evaluate scattering data in forward direction.
+   *
+   * Evaluates the scattering-angle expansion at a scattering angle of 0
+   * directly from the m = 0 coefficients, i.e. without synthesizing the
+   * data on the scattering-angle grid.
+   *
+   * @return Rank-5 tensor containing the data in forward direction for
+   * all frequencies, temperatures, incoming angles and data elements.
+   */
+  eigen::Tensor<Scalar, 5> evaluate_forward() const {
+    return evaluate_pole(false);
+  }
+
+  /** Evaluate scattering data in backward direction.
+   *
+   * Evaluates the scattering-angle expansion at a scattering angle of pi
+   * directly from the m = 0 coefficients, i.e. without synthesizing the
+   * data on the scattering-angle grid.
+   *
+   * @return Rank-5 tensor containing the data in backward direction for
+   * all frequencies, temperatures, incoming angles and data elements.
+   */
+  eigen::Tensor<Scalar, 5> evaluate_backward() const {
+    return evaluate_pole(true);
   }
 
   /** Normalize w.r.t. scattering-angle integral.
@@ -1189,19 +1469,18 @@ class ScatteringDataFieldSpectral : public ScatteringDataFieldBase {
    */
   ScatteringDataFieldSpectral &operator+=(
       const ScatteringDataFieldSpectral &other) {
-    auto regridded = other.regrid(f_grid_, t_grid_, lon_inc_, lat_inc_);
-    eigen::IndexArray<5> dimensions_loop = {n_freqs_,
-                                            n_temps_,
-                                            n_lon_inc_,
-                                            n_lat_inc_,
-                                            data_->dimension(5)};
-    for (eigen::DimensionCounter<5> i{dimensions_loop}; i; ++i) {
-      auto result = eigen::get_subvector<4>(*data_, i.coordinates);
-      auto in_l = eigen::get_subvector<4>(*data_, i.coordinates);
-      auto in_r = eigen::get_subvector<4>(*regridded.data_, i.coordinates);
-      result =
-          sht::SHT::add_coeffs(*sht_scat_, in_l, *regridded.sht_scat_, in_r);
+    auto source = other.data_;
+    if (!(is_same_grid(f_grid_, other.f_grid_) &&
+          is_same_grid(t_grid_, other.t_grid_) &&
+          is_same_grid(lon_inc_, other.lon_inc_) &&
+          is_same_grid(lat_inc_, other.lat_inc_))) {
+      source = other.regrid(f_grid_, t_grid_, lon_inc_, lat_inc_).data_;
     }
+    auto index_map = sht::SpectralIndexMap::get(*other.sht_scat_, *sht_scat_);
+    index_map->accumulate(data_->data(),
+                          source->data(),
+                          n_freqs_ * n_temps_ * n_lon_inc_ * n_lat_inc_,
+                          data_->dimension(5));
     return *this;
   }
 
@@ -1262,6 +1541,11 @@ class ScatteringDataFieldSpectral : public ScatteringDataFieldBase {
   }
 
   /** Convert data to SHT representation with other parameters.
+   *
+   * Truncates or zero-pads the scattering-angle coefficients. Since the
+   * grids of the result are the same as the ones of this object, the
+   * coefficients are copied directly, one frequency slice at a time, so
+   * that no intermediate copy of the data is required.
    *
    * @param sht_other SHT object representing SHT-representation to convert to.
    * @returns A new ScatteringDataFieldSpectral object containg the scattering
@@ -1270,16 +1554,24 @@ class ScatteringDataFieldSpectral : public ScatteringDataFieldBase {
   ScatteringDataFieldSpectral to_spectral(ShtPtr sht_other) const {
     auto new_dimensions = data_->dimensions();
     new_dimensions[4] = sht_other->get_n_spectral_coeffs();
-    auto data_new_ =
-        std::make_shared<DataTensor>(DataTensor(new_dimensions).setZero());
-    auto result = ScatteringDataFieldSpectral(f_grid_,
-                                              t_grid_,
-                                              lon_inc_,
-                                              lat_inc_,
-                                              sht_other,
-                                              data_new_);
-    result += *this;
-    return result;
+    auto data_new = std::make_shared<DataTensor>(new_dimensions);
+    auto index_map = sht::SpectralIndexMap::get(*sht_scat_, *sht_other);
+    Index n_outer = n_temps_ * n_lon_inc_ * n_lat_inc_;
+    Index n_inner = data_->dimension(5);
+    Index stride_source = n_outer * data_->dimension(4) * n_inner;
+    Index stride_destination = n_outer * new_dimensions[4] * n_inner;
+    for (Index i = 0; i < n_freqs_; ++i) {
+      index_map->copy(data_new->data() + i * stride_destination,
+                      data_->data() + i * stride_source,
+                      n_outer,
+                      n_inner);
+    }
+    return ScatteringDataFieldSpectral(f_grid_,
+                                       t_grid_,
+                                       lon_inc_,
+                                       lat_inc_,
+                                       sht_other,
+                                       data_new);
   }
 
   /** Convert data to SHT representation with other parameters.
@@ -1292,7 +1584,7 @@ class ScatteringDataFieldSpectral : public ScatteringDataFieldBase {
   ScatteringDataFieldSpectral to_spectral(Index l_max, Index m_max) const {
     auto n_lat = sht_scat_->get_n_latitudes();
     auto n_lon = sht_scat_->get_n_longitudes();
-    return to_spectral(std::make_shared<sht::SHT>(l_max, m_max, n_lon, n_lat));
+    return to_spectral(sht::SHTProvider::get(l_max, m_max, n_lon, n_lat));
   }
 
   /** Convert data to SHT representation with other parameters.
@@ -1310,7 +1602,7 @@ class ScatteringDataFieldSpectral : public ScatteringDataFieldBase {
                                           Index m_max,
                                           Index n_lon,
                                           Index n_lat) const {
-      return to_spectral(std::make_shared<sht::SHT>(l_max, m_max, n_lon, n_lat));
+      return to_spectral(sht::SHTProvider::get(l_max, m_max, n_lon, n_lat));
   }
 
   /** Convert data to SHT representation with other parameters.
@@ -1323,6 +1615,35 @@ class ScatteringDataFieldSpectral : public ScatteringDataFieldBase {
     return to_spectral(l_max, l_max);
   }
 
+  /** Relative truncation error of scattering-angle expansion.
+   *
+   * The error is computed from the power spectrum of each scattering-angle
+   * expansion in the field as the square root of the fraction of the total
+   * power contained in the modes that are discarded when truncating the
+   * expansion to the given l_max and m_max. Since the SH basis is
+   * orthonormal, this is the relative L2 error of the truncated expansion.
+   *
+   * @param l_max The l_max value of the truncated expansion.
+   * @param m_max The m_max value of the truncated expansion.
+   * @return The maximum relative truncation error over all expansions in
+   * the field.
+   */
+  Scalar get_truncation_error(Index l_max, Index m_max) const;
+
+  /** Compress scattering data by truncating the scattering-angle expansion.
+   *
+   * Determines the truncation (l_max, m_max) with the smallest number of
+   * coefficients for which the relative truncation error, as defined by
+   * get_truncation_error(...), does not exceed the given tolerance for
+   * any of the expansions in the field.
+   *
+   * @param tolerance The maximum relative truncation error.
+   * @return Pair containing the scattering data field with the truncated
+   * scattering-angle expansion and its relative truncation error.
+   */
+  std::pair<ScatteringDataFieldSpectral, Scalar> compress(
+      Scalar tolerance) const;
+
   /** Convert data gridded representation.
    *
    * @returns A new ScatteringDataFieldSpectral object containg the scattering
@@ -1333,20 +1654,59 @@ class ScatteringDataFieldSpectral : public ScatteringDataFieldBase {
 
   ScatteringDataFieldGridded<Scalar> to_gridded(Index n_lon,
                                                 Index n_lat) const {
-      auto sht = std::make_shared<sht::SHT>(sht_scat_->get_l_max(),
+      auto sht = sht::SHTProvider::get(sht_scat_->get_l_max(),
                                             sht_scat_->get_m_max(),
                                             n_lon,
                                             n_lat);
       return to_spectral(sht).to_gridded();
   }
 
+  // pxx :: hide
+  /** Rotate scattering-angle dependency to lab frame.
+   *
+   * For randomly-oriented particles, the scattering data depends only on
+   * the scattering angle and is thus represented by an expansion with
+   * m_max == 0. In the lab frame, the data for a given incoming latitude is
+   * the same function rotated so that its symmetry axis points along the
+   * incoming direction. This method applies this rotation directly to the
+   * SH coefficients, which avoids synthesizing the data on a dense angular
+   * grid and regridding it.
+   *
+   * Only the phase function, i.e. the first element, transforms as a scalar
+   * field under this rotation. The other elements would additionally
+   * require the rotation of the polarization reference frame, so the
+   * result contains only the phase function and corresponds to a stokes
+   * dimension of 1.
+   *
+   * @param lat_inc The incoming-angle latitude grid of the lab-frame data.
+   * @return Spectral phase function data with the given incoming-angle
+   * latitudes and a scattering-angle SHT with m_max == l_max.
+   */
+  ScatteringDataFieldSpectral to_lab_frame(VectorPtr lat_inc) const;
+
+  /** Rotate scattering-angle dependency to lab frame.
+   * @param lat_inc The incoming-angle latitude grid of the lab-frame data.
+   * @return Spectral phase function data with the given incoming-angle
+   * latitudes.
+   */
+  ScatteringDataFieldSpectral to_lab_frame(Vector lat_inc) const {
+    return to_lab_frame(std::make_shared<Vector>(lat_inc));
+  }
+
   /** Convert data to fully-spectral representation.
+   *
+   * If sparse is true, data that is independent of the incoming-angle
+   * longitude is transformed using only the m = 0 modes and the result is
+   * reduced to its active incoming-angle modes using compact().
    *
    * @param sht SHT object to use to perform the incoming-angle transform.
+   * @param sparse Whether to store only the active incoming-angle modes.
    * @returns Representation of this scattering data converted to fully-spectral
    * format.
    */
-  ScatteringDataFieldFullySpectral<Scalar> to_fully_spectral(ShtPtr sht) const;
+  ScatteringDataFieldFullySpectral<Scalar> to_fully_spectral(
+      ShtPtr sht,
+      bool sparse = false) const;
 
   /** Convert data to fully-spectral representation.
    *
@@ -1360,8 +1720,8 @@ class ScatteringDataFieldSpectral : public ScatteringDataFieldBase {
   ScatteringDataFieldFullySpectral<Scalar> to_fully_spectral(
       Index l_max,
       Index m_max) const {
-    std::shared_ptr<sht::SHT> sht =
-        std::make_shared<sht::SHT>(l_max, m_max, n_lon_inc_, n_lat_inc_);
+    std::shared_ptr<const sht::SHT> sht =
+        sht::SHTProvider::get(l_max, m_max, n_lon_inc_, n_lat_inc_);
     return to_fully_spectral(sht);
   }
 
@@ -1380,6 +1740,77 @@ class ScatteringDataFieldSpectral : public ScatteringDataFieldBase {
   }
 
  protected:
+  /** Relative power spectra of the scattering-angle expansions.
+   *
+   * @return Matrix with one row for each expansion in the field containing
+   * the power of each coefficient relative to the total power of the
+   * expansion. Rows of expansions with zero power are zero.
+   */
+  Matrix get_relative_power_spectra() const {
+    Index n_coeffs = data_->dimension(4);
+    Index n_elements = data_->dimension(5);
+    Index n_outer = data_->size() / (n_coeffs * n_elements);
+    auto m = sht_scat_->get_m_indices();
+    Matrix power(n_outer * n_elements, n_coeffs);
+    const std::complex<Scalar> *data = data_->data();
+    for (Index i = 0; i < n_outer; ++i) {
+      for (Index j = 0; j < n_coeffs; ++j) {
+        // Coefficients with m > 0 represent the modes m and -m.
+        Scalar weight = (m[j] > 0) ? 2.0 : 1.0;
+        for (Index k = 0; k < n_elements; ++k) {
+          power(i * n_elements + k, j) =
+              weight * std::norm(data[(i * n_coeffs + j) * n_elements + k]);
+        }
+      }
+    }
+    for (Index i = 0; i < power.rows(); ++i) {
+      Scalar total = power.row(i).sum();
+      if (total > 0.0) {
+        power.row(i) /= total;
+      }
+    }
+    return power;
+  }
+
+  /// Evaluate scattering-angle expansion at theta = 0 or theta = pi.
+  eigen::Tensor<Scalar, 5> evaluate_pole(bool backward) const {
+    auto weights = sht_scat_->get_pole_weights(backward);
+    Index n_outer = n_freqs_ * n_temps_ * n_lon_inc_ * n_lat_inc_;
+    Index n_coeffs = data_->dimension(4);
+    Index n_elements = data_->dimension(5);
+    eigen::Tensor<Scalar, 5> result{
+        {n_freqs_, n_temps_, n_lon_inc_, n_lat_inc_, n_elements}};
+    result.setZero();
+    const std::complex<Scalar> *data = data_->data();
+    Scalar *output = result.data();
+    for (Index i = 0; i < n_outer; ++i) {
+      const std::complex<Scalar> *coeffs = data + i * n_coeffs * n_elements;
+      Scalar *values = output + i * n_elements;
+      for (Index l = 0; l < weights.size(); ++l) {
+        Scalar w = static_cast<Scalar>(weights[l]);
+        for (Index j = 0; j < n_elements; ++j) {
+          values[j] += w * coeffs[l * n_elements + j].real();
+        }
+      }
+    }
+    return result;
+  }
+
+  /// Whether the data is constant along the incoming-angle longitudes.
+  bool is_azimuthally_symmetric_inc() const {
+    Index n_outer = n_freqs_ * n_temps_;
+    Index n_inner = data_->size() / (n_outer * n_lon_inc_);
+    const std::complex<Scalar> *data = data_->data();
+    for (Index i = 0; i < n_outer; ++i) {
+      const std::complex<Scalar> *first = data + i * n_lon_inc_ * n_inner;
+      for (Index j = 1; j < n_lon_inc_; ++j) {
+        if (!std::equal(first, first + n_inner, first + j * n_inner)) {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
 
   VectorPtr f_grid_;
   VectorPtr t_grid_;
@@ -1399,6 +1830,7 @@ class ScatteringDataFieldSpectral : public ScatteringDataFieldBase {
 
 // pxx :: export
 // pxx :: instance(["double"])
+// pxx :: instance("ScatteringDataFieldFullySpectralFloat", ["float"])
 ////////////////////////////////////////////////////////////////////////////////
 // Fully-spectral format
 ////////////////////////////////////////////////////////////////////////////////
@@ -1441,7 +1873,8 @@ class ScatteringDataFieldFullySpectral : public ScatteringDataFieldBase {
   using Matrix = eigen::Matrix<Scalar>;
   using MatrixMap = eigen::MatrixMap<Scalar>;
   using ConstMatrixMap = eigen::ConstMatrixMap<Scalar>;
-  using ShtPtr = std::shared_ptr<sht::SHT>;
+  using Coefficient = std::complex<Scalar>;
+  using ShtPtr = std::shared_ptr<const sht::SHT>;
 
   template <eigen::Index rank>
   using CmplxTensor = eigen::Tensor<std::complex<Scalar>, rank>;
@@ -1503,8 +1936,8 @@ class ScatteringDataFieldFullySpectral : public ScatteringDataFieldBase {
                                 sht_scat.get_n_latitudes()),
         f_grid_(std::make_shared<Vector>(f_grid)),
         t_grid_(std::make_shared<Vector>(t_grid)),
-        sht_inc_(std::make_shared<sht::SHT>(sht_inc)),
-        sht_scat_(std::make_shared<sht::SHT>(sht_scat)),
+        sht_inc_(sht::SHTProvider::get(sht_inc)),
+        sht_scat_(sht::SHTProvider::get(sht_scat)),
         f_grid_map_(f_grid_->data(), n_freqs_),
         t_grid_map_(t_grid_->data(), n_temps_),
         data_(std::make_shared<DataTensor>(data)) {}
@@ -1531,8 +1964,8 @@ class ScatteringDataFieldFullySpectral : public ScatteringDataFieldBase {
                                 sht_scat.get_n_latitudes()),
         f_grid_(std::make_shared<Vector>(f_grid)),
         t_grid_(std::make_shared<Vector>(t_grid)),
-        sht_inc_(std::make_shared<sht::SHT>(sht_inc)),
-        sht_scat_(std::make_shared<sht::SHT>(sht_scat)),
+        sht_inc_(sht::SHTProvider::get(sht_inc)),
+        sht_scat_(sht::SHTProvider::get(sht_scat)),
         f_grid_map_(f_grid_->data(), n_freqs_),
         t_grid_map_(t_grid_->data(), n_temps_),
         data_(std::make_shared<DataTensor>(
@@ -1579,28 +2012,28 @@ class ScatteringDataFieldFullySpectral : public ScatteringDataFieldBase {
               sht_scat_->get_n_latitudes()};
   }
   /// The frequency grid.
-  const eigen::Vector<double>& get_f_grid() { return *f_grid_; }
+  const Vector &get_f_grid() { return *f_grid_; }
   /// The temperature grid.
-  const eigen::Vector<double>& get_t_grid() { return *t_grid_; }
+  const Vector &get_t_grid() { return *t_grid_; }
   /// The incoming-angle longitude grid.
-  eigen::Vector<double> get_lon_inc() { return sht_inc_->get_longitude_grid(); }
+  Vector get_lon_inc() { return sht_inc_->get_longitude_grid().cast<Scalar>(); }
   /// The incoming-angle latitude grid.
-  eigen::Vector<double> get_lat_inc() { return sht_inc_->get_latitude_grid(); }
+  Vector get_lat_inc() { return sht_inc_->get_latitude_grid().cast<Scalar>(); }
   /// The scattering-angle longitude grid.
-  eigen::Vector<double> get_lon_scat() {
-    return sht_scat_->get_longitude_grid();
+  Vector get_lon_scat() {
+    return sht_scat_->get_longitude_grid().cast<Scalar>();
   }
   /// The scattering-angle latitude grid.
-  eigen::Vector<double> get_lat_scat() {
-    return sht_scat_->get_latitude_grid();
+  Vector get_lat_scat() {
+    return sht_scat_->get_latitude_grid().cast<Scalar>();
   }
 
   /// The SHT object representing the SHT transform used to transform
   /// the data along the incoming angles.
-  sht::SHT &get_sht_inc() const { return *sht_inc_; }
+  const sht::SHT &get_sht_inc() const { return *sht_inc_; }
   /// The SHT object representing the SHT transform used to transform
   /// the data along the scattering angles.
-  sht::SHT &get_sht_scat() const { return *sht_scat_; }
+  const sht::SHT &get_sht_scat() const { return *sht_scat_; }
 
   /** Set scattering data for given frequency and temperature index.
    *
@@ -1623,19 +2056,14 @@ class ScatteringDataFieldFullySpectral : public ScatteringDataFieldBase {
     std::array<eigen::Index, 2> input_index = {0, 0};
     auto data_map = eigen::tensor_index(*data_, data_index);
     auto other_data_map = eigen::tensor_index(*other.data_, input_index);
-
-    eigen::IndexArray<1> dimensions_loop = {data_->dimension(5)};
-    for (eigen::DimensionCounter<1> i{dimensions_loop}; i; ++i) {
-      auto result = eigen::get_submatrix<0, 1>(data_map, i.coordinates);
-      auto in_l = eigen::get_submatrix<0, 1>(data_map, i.coordinates);
-      auto in_r = eigen::get_submatrix<0, 1>(other_data_map, i.coordinates);
-      result = sht::SHT::add_coeffs(*sht_inc_,
-                                    *sht_scat_,
-                                    in_l,
-                                    *other.sht_inc_,
-                                    *other.sht_scat_,
-                                    in_r);
-    }
+    auto map_inc = sht::SpectralIndexMap::get(*other.sht_inc_, *sht_inc_, true);
+    auto map_scat = sht::SpectralIndexMap::get(*other.sht_scat_, *sht_scat_);
+    sht::SpectralIndexMap::accumulate(data_map.data(),
+                                      other_data_map.data(),
+                                      1,
+                                      *map_inc,
+                                      *map_scat,
+                                      data_->dimension(4));
   }
 
   // pxx :: hide
@@ -1646,8 +2074,23 @@ class ScatteringDataFieldFullySpectral : public ScatteringDataFieldBase {
    */
   ScatteringDataFieldFullySpectral interpolate_frequency(
       std::shared_ptr<Vector> frequencies) const {
-    using Regridder = RegularRegridder<Scalar, 0>;
-    Regridder regridder({*f_grid_}, {*frequencies});
+    return interpolate_frequency(
+        frequencies,
+        InterpolationPlan<Scalar>::get(*f_grid_, *frequencies));
+  }
+
+  // pxx :: hide
+  /** Linear interpolation along frequency dimension using precomputed plan.
+   * @param frequencies The frequencies to which to interpolate the data.
+   * @param plan Interpolation plan from the frequency grid of this object
+   * to the given frequencies.
+   * @return New ScatteringDataFieldFullySpectral with the data interpolated
+   * to the given frequencies.
+   */
+  ScatteringDataFieldFullySpectral interpolate_frequency(
+      std::shared_ptr<Vector> frequencies,
+      InterpolationPlanPtr<Scalar> plan) const {
+    RegularRegridder<Scalar, 0> regridder({plan});
     auto dimensions_new = data_->dimensions();
     auto data_interp = regridder.regrid(*data_);
     dimensions_new[0] = frequencies->size();
@@ -1678,8 +2121,23 @@ class ScatteringDataFieldFullySpectral : public ScatteringDataFieldBase {
   ScatteringDataFieldFullySpectral interpolate_temperature(
       std::shared_ptr<Vector> temperatures,
       bool extrapolate=false) const {
-    using Regridder = RegularRegridder<Scalar, 1>;
-    Regridder regridder({*t_grid_}, {*temperatures}, extrapolate);
+    return interpolate_temperature(
+        temperatures,
+        InterpolationPlan<Scalar>::get(*t_grid_, *temperatures, extrapolate));
+  }
+
+  // pxx :: hide
+  /** Linear interpolation along temperature dimension using precomputed plan.
+   * @param temperatures The temperatures to which to interpolate the data.
+   * @param plan Interpolation plan from the temperature grid of this object
+   * to the given temperatures.
+   * @return New ScatteringDataFieldFullySpectral with the data interpolated
+   * to the given temperatures.
+   */
+  ScatteringDataFieldFullySpectral interpolate_temperature(
+      std::shared_ptr<Vector> temperatures,
+      InterpolationPlanPtr<Scalar> plan) const {
+    RegularRegridder<Scalar, 1> regridder({plan});
     auto dimensions_new = data_->dimensions();
     auto data_interp = regridder.regrid(*data_);
     dimensions_new[1] = temperatures->size();
@@ -1704,6 +2162,61 @@ class ScatteringDataFieldFullySpectral : public ScatteringDataFieldBase {
                                      extrapolate);
   }
 
+  /** Number of elements of the data at a single frequency and temperature.
+   *
+   * This is the size of the buffer required by interpolate_point(...).
+   */
+  Index get_point_size() const { return data_->size() / (n_freqs_ * n_temps_); }
+
+  // pxx :: hide
+  /** Interpolate data to a single frequency and temperature.
+   *
+   * Fused linear interpolation along frequency and temperature that writes
+   * the result directly into a caller-supplied buffer without allocating
+   * intermediate tensors. The buffer is filled with the data tensor
+   * layout with the frequency and temperature dimensions removed.
+   *
+   * @param output Pointer to a buffer that can hold get_point_size()
+   * elements.
+   * @param frequency The frequency to interpolate the data to.
+   * @param temperature The temperature to interpolate the data to.
+   * @param extrapolate Whether to extrapolate linearly along temperatures.
+   */
+  void interpolate_point(Coefficient *output,
+                         Scalar frequency,
+                         Scalar temperature,
+                         bool extrapolate = false) const {
+    ScatteringDataFieldBase::interpolate_point(output,
+                                              data_->data(),
+                                              *f_grid_,
+                                              *t_grid_,
+                                              frequency,
+                                              temperature,
+                                              get_point_size(),
+                                              extrapolate);
+  }
+
+  /** Interpolate data to a single frequency and temperature.
+   * @param frequency The frequency to interpolate the data to.
+   * @param temperature The temperature to interpolate the data to.
+   * @param extrapolate Whether to extrapolate linearly along temperatures.
+   * @return Tensor containing the interpolated data with the frequency and
+   * temperature dimensions removed.
+   */
+  eigen::Tensor<Coefficient, DataTensor::NumIndices - 2> interpolate_point(
+      Scalar frequency,
+      Scalar temperature,
+      bool extrapolate = false) const {
+    constexpr int rank_out = DataTensor::NumIndices - 2;
+    std::array<Index, rank_out> dimensions;
+    for (int i = 0; i < rank_out; ++i) {
+      dimensions[i] = data_->dimension(i + 2);
+    }
+    eigen::Tensor<Coefficient, rank_out> result{dimensions};
+    interpolate_point(result.data(), frequency, temperature, extrapolate);
+    return result;
+  }
+
   /** Regrid data to new frequency and temperature grids.
    * @param f_grid The frequency grid.
    * @param t_grid The temperature grid.
@@ -1733,21 +2246,21 @@ class ScatteringDataFieldFullySpectral : public ScatteringDataFieldBase {
    */
   ScatteringDataFieldFullySpectral &operator+=(
       const ScatteringDataFieldFullySpectral &other) {
-    auto regridded = other.regrid(f_grid_, t_grid_);
-    eigen::IndexArray<3> dimensions_loop = {n_freqs_,
-                                            n_temps_,
-                                            data_->dimension(4)};
-    for (eigen::DimensionCounter<3> i{dimensions_loop}; i; ++i) {
-      auto result = eigen::get_submatrix<2, 3>(*data_, i.coordinates);
-      auto in_l = eigen::get_submatrix<2, 3>(*data_, i.coordinates);
-      auto in_r = eigen::get_submatrix<2, 3>(*regridded.data_, i.coordinates);
-      result = sht::SHT::add_coeffs(*sht_inc_,
-                                    *sht_scat_,
-                                    in_l,
-                                    *regridded.sht_inc_,
-                                    *regridded.sht_scat_,
-                                    in_r);
+    auto source = other.data_;
+    if (!(is_same_grid(f_grid_, other.f_grid_) &&
+          is_same_grid(t_grid_, other.t_grid_))) {
+      source = other.regrid(f_grid_, t_grid_).data_;
     }
+    auto map_inc =
+        sht::SpectralIndexMap::get(*other.sht_inc_, *sht_inc_, true);
+    auto map_scat =
+        sht::SpectralIndexMap::get(*other.sht_scat_, *sht_scat_);
+    sht::SpectralIndexMap::accumulate(data_->data(),
+                                      source->data(),
+                                      n_freqs_ * n_temps_,
+                                      *map_inc,
+                                      *map_scat,
+                                      data_->dimension(4));
     return *this;
   }
 
@@ -1821,14 +2334,23 @@ class ScatteringDataFieldFullySpectral : public ScatteringDataFieldBase {
   ScatteringDataFieldSpectral<Scalar> to_spectral(ShtPtr sht_other) const {
     auto new_dimensions = data_->dimensions();
     new_dimensions[3] = sht_other->get_n_spectral_coeffs();
-    auto data_new_ =
-        std::make_shared<DataTensor>(DataTensor(new_dimensions).setZero());
+    auto data_new = std::make_shared<DataTensor>(new_dimensions);
+    auto index_map = sht::SpectralIndexMap::get(*sht_scat_, *sht_other);
+    Index n_outer = n_temps_ * data_->dimension(2);
+    Index n_inner = data_->dimension(4);
+    Index stride_source = n_outer * data_->dimension(3) * n_inner;
+    Index stride_destination = n_outer * new_dimensions[3] * n_inner;
+    for (Index i = 0; i < n_freqs_; ++i) {
+      index_map->copy(data_new->data() + i * stride_destination,
+                      data_->data() + i * stride_source,
+                      n_outer,
+                      n_inner);
+    }
     auto result = ScatteringDataFieldFullySpectral(f_grid_,
                                                    t_grid_,
                                                    sht_inc_,
                                                    sht_other,
-                                                   data_new_);
-    result += *this;
+                                                   data_new);
     return result.to_spectral();
   }
 
@@ -1845,7 +2367,7 @@ class ScatteringDataFieldFullySpectral : public ScatteringDataFieldBase {
                                                   Index m_max) const {
     auto n_lat = sht_scat_->get_n_latitudes();
     auto n_lon = sht_scat_->get_n_longitudes();
-    auto sht_other = std::make_shared<sht::SHT>(l_max, m_max, n_lon, n_lat);
+    auto sht_other = sht::SHTProvider::get(l_max, m_max, n_lon, n_lat);
     return to_spectral(sht_other);
   }
 
@@ -1866,10 +2388,35 @@ class ScatteringDataFieldFullySpectral : public ScatteringDataFieldBase {
                                                   Index m_max,
                                                   Index n_lon,
                                                   Index n_lat) const {
-      auto sht_other = std::make_shared<sht::SHT>(l_max, m_max, n_lon, n_lat);
+      auto sht_other = sht::SHTProvider::get(l_max, m_max, n_lon, n_lat);
       return to_spectral(sht_other);
   }
 
+  /** Determine active incoming-angle modes.
+   *
+   * @param relative_tolerance Coefficients whose magnitude does not exceed
+   * this fraction of the largest coefficient magnitude are considered zero.
+   * @return Pair containing the largest degree l and the largest order |m|
+   * of the incoming-angle expansion with non-zero coefficients.
+   */
+  std::pair<Index, Index> get_active_modes_inc(Scalar relative_tolerance) const;
+
+  /** Sparse representation of scattering data.
+   *
+   * Truncates the incoming-angle expansion to the active (l, m) modes so
+   * that only the non-zero coefficient blocks are stored. For azimuthally-
+   * symmetric particles this reduces the incoming-angle expansion to the
+   * m = 0 modes. The degree is not reduced below l = 1, so that the
+   * incoming-angle grids of the result are preserved.
+   *
+   * @param relative_tolerance Coefficients whose magnitude does not exceed
+   * this fraction of the largest coefficient magnitude are considered zero.
+   * @return Scattering data field with reduced incoming-angle SHT.
+   */
+  ScatteringDataFieldFullySpectral compact(
+      Scalar relative_tolerance =
+          64 * std::numeric_limits<Scalar>::epsilon()) const;
+
   const DataTensor &get_data() const { return *data_; }
 
  protected:
@@ -1893,12 +2440,7 @@ class ScatteringDataFieldFullySpectral : public ScatteringDataFieldBase {
 template <typename Scalar>
 ScatteringDataFieldSpectral<Scalar>
 ScatteringDataFieldGridded<Scalar>::to_spectral(
-    std::shared_ptr<sht::SHT> sht) const {
-  eigen::IndexArray<5> dimensions_loop = {n_freqs_,
-                                          n_temps_,
-                                          n_lon_inc_,
-                                          n_lat_inc_,
-                                          data_->dimension(6)};
+    std::shared_ptr<const sht::SHT> sht) const {
   eigen::IndexArray<6> dimensions_new = {n_freqs_,
                                          n_temps_,
                                          n_lon_inc_,
@@ -1907,9 +2449,36 @@ ScatteringDataFieldGridded<Scalar>::to_spectral(
                                          data_->dimension(6)};
   using CmplxDataTensor = eigen::Tensor<std::complex<Scalar>, 6>;
   auto data_new = std::make_shared<CmplxDataTensor>(dimensions_new);
-  for (eigen::DimensionCounter<5> i{dimensions_loop}; i; ++i) {
-    eigen::get_subvector<4>(*data_new, i.coordinates) =
-        sht->transform(eigen::get_submatrix<4, 5>(*data_, i.coordinates));
+
+  // Flatten outer dimensions so that incoming angles can be distributed
+  // over threads.
+  Index n_outer = n_freqs_ * n_temps_ * n_lon_inc_ * n_lat_inc_;
+  eigen::IndexArray<3> dimensions_in = {data_->dimension(4),
+                                        data_->dimension(5),
+                                        data_->dimension(6)};
+  eigen::IndexArray<2> dimensions_out = {data_new->dimension(4),
+                                         data_new->dimension(5)};
+  Index stride_in = dimensions_in[0] * dimensions_in[1] * dimensions_in[2];
+  Index stride_out = dimensions_out[0] * dimensions_out[1];
+
+  [[maybe_unused]] Index n_threads = sht->get_n_threads_across(n_outer);
+#ifdef _OPENMP
+#pragma omp parallel num_threads(n_threads) if (n_threads > 1)
+#endif
+  {
+    auto workspace = sht->create_workspace();
+#ifdef _OPENMP
+#pragma omp for
+#endif
+    for (Index i = 0; i < n_outer; ++i) {
+      sht->transform_batch(
+          eigen::TensorMap<std::complex<Scalar>, 2>(
+              data_new->data() + i * stride_out,
+              dimensions_out),
+          eigen::ConstTensorMap<Scalar, 3>(data_->data() + i * stride_in,
+                                           dimensions_in),
+          workspace);
+    }
   }
   return ScatteringDataFieldSpectral<Scalar>(f_grid_,
                                              t_grid_,
@@ -1922,11 +2491,6 @@ ScatteringDataFieldGridded<Scalar>::to_spectral(
 template <typename Scalar>
 ScatteringDataFieldGridded<Scalar>
 ScatteringDataFieldSpectral<Scalar>::to_gridded() const {
-  eigen::IndexArray<5> dimensions_loop = {n_freqs_,
-                                          n_temps_,
-                                          n_lon_inc_,
-                                          n_lat_inc_,
-                                          data_->dimension(5)};
   eigen::IndexArray<7> dimensions_new = {n_freqs_,
                                          n_temps_,
                                          n_lon_inc_,
@@ -1937,13 +2501,55 @@ ScatteringDataFieldSpectral<Scalar>::to_gridded() const {
   using Vector = eigen::Vector<Scalar>;
   using DataTensor = eigen::Tensor<Scalar, 7>;
   auto data_new = std::make_shared<DataTensor>(dimensions_new);
-  for (eigen::DimensionCounter<5> i{dimensions_loop}; i; ++i) {
-      auto synthesized = sht_scat_->synthesize(eigen::get_subvector<4>(*data_, i.coordinates));
-    eigen::get_submatrix<4, 5>(*data_new, i.coordinates) =
-        sht_scat_->synthesize(eigen::get_subvector<4>(*data_, i.coordinates));
+
+  Index n_outer = n_freqs_ * n_temps_ * n_lon_inc_ * n_lat_inc_;
+  eigen::IndexArray<2> dimensions_in = {data_->dimension(4),
+                                        data_->dimension(5)};
+  eigen::IndexArray<3> dimensions_out = {data_new->dimension(4),
+                                         data_new->dimension(5),
+                                         data_new->dimension(6)};
+  Index stride_in = dimensions_in[0] * dimensions_in[1];
+  Index stride_out = dimensions_out[0] * dimensions_out[1] * dimensions_out[2];
+
+  // Azimuthally symmetric data is synthesized using a cached Legendre
+  // table, which reduces the synthesis to a matrix product.
+  if ((sht_scat_->get_m_max() == 0) && (sht_scat_->get_l_max() > 0)) {
+    auto legendre = sht::LegendreExpansion::get(
+        sht_scat_->get_l_max(),
+        sht_scat_->get_colatitude_grid());
+    for (Index i = 0; i < n_outer; ++i) {
+      legendre->evaluate(
+          eigen::TensorMap<Scalar, 3>(data_new->data() + i * stride_out,
+                                      dimensions_out),
+          eigen::ConstTensorMap<std::complex<Scalar>, 2>(
+              data_->data() + i * stride_in,
+              dimensions_in));
+    }
+  } else {
+    [[maybe_unused]] Index n_threads = sht_scat_->get_n_threads_across(n_outer);
+#ifdef _OPENMP
+#pragma omp parallel num_threads(n_threads) if (n_threads > 1)
+#endif
+    {
+      auto workspace = sht_scat_->create_workspace();
+#ifdef _OPENMP
+#pragma omp for
+#endif
+      for (Index i = 0; i < n_outer; ++i) {
+        sht_scat_->synthesize_batch(
+            eigen::TensorMap<Scalar, 3>(data_new->data() + i * stride_out,
+                                        dimensions_out),
+            eigen::ConstTensorMap<std::complex<Scalar>, 2>(
+                data_->data() + i * stride_in,
+                dimensions_in),
+            workspace);
+      }
+    }
   }
-  auto lon_scat_ = std::make_shared<Vector>(sht_scat_->get_longitude_grid());
-  auto lat_scat_ = std::make_shared<sht::SHT::LatGrid>(sht_scat_->get_latitude_grid());
+  auto lon_scat_ = std::make_shared<Vector>(
+      sht_scat_->get_longitude_grid().cast<Scalar>());
+  auto lat_scat_ = std::make_shared<sht::LatGrid<Scalar>>(
+      (sht_scat_->get_l_max() > 0) ? sht_scat_->get_n_latitudes() : 1);
   return ScatteringDataFieldGridded<Scalar>(f_grid_,
                                             t_grid_,
                                             lon_inc_,
@@ -1953,14 +2559,74 @@ ScatteringDataFieldSpectral<Scalar>::to_gridded() const {
                                             data_new);
 }
 
+template <typename Scalar>
+ScatteringDataFieldSpectral<Scalar>
+ScatteringDataFieldSpectral<Scalar>::to_lab_frame(VectorPtr lat_inc) const {
+  assert(n_lon_inc_ == 1);
+  assert(n_lat_inc_ == 1);
+  assert(sht_scat_->get_m_max() == 0);
+
+  // The rotated expansions contain all m up to l_max.
+  Index l_max = sht_scat_->get_l_max();
+  Index n_lon = (l_max > 0) ? std::max<Index>(n_lon_scat_, 2 * l_max + 2)
+                            : n_lon_scat_;
+  auto sht = sht::SHTProvider::get(l_max, l_max, n_lon, n_lat_scat_);
+
+  Index n_lat_inc = lat_inc->size();
+  Index n_coeffs_in = data_->dimension(4);
+  Index n_coeffs = sht->get_n_spectral_coeffs();
+  Index n_elements = data_->dimension(5);
+  auto data_new = std::make_shared<DataTensor>(
+      std::array<Index, 6>{n_freqs_, n_temps_, 1, n_lat_inc, n_coeffs, 1});
+
+  // The zonal coefficients form the leading m = 0 block of both expansions,
+  // so each rotation only needs to gather the l_max + 1 input coefficients
+  // of the phase function.
+  Index n_rotations = n_freqs_ * n_temps_ * n_lat_inc;
+#ifdef _OPENMP
+  Index n_threads = sht->get_n_threads_across(n_rotations);
+#pragma omp parallel num_threads(n_threads) if (n_threads > 1)
+#endif
+  {
+    eigen::Vector<std::complex<double>> coeffs(n_coeffs);
+#ifdef _OPENMP
+#pragma omp for
+#endif
+    for (Index i = 0; i < n_rotations; ++i) {
+      Index outer_index = i / n_lat_inc;
+      Index lat_index = i % n_lat_inc;
+      const Coefficient *src =
+          data_->data() + outer_index * n_coeffs_in * n_elements;
+      Coefficient *dst = data_new->data() + i * n_coeffs;
+      coeffs.setZero();
+      for (Index j = 0; j < n_coeffs_in; ++j) {
+        coeffs[j] = src[j * n_elements];
+      }
+      coeffs = sht->rotate_y(coeffs, lat_inc->operator[](lat_index));
+      for (Index j = 0; j < n_coeffs; ++j) {
+        dst[j] = static_cast<Coefficient>(coeffs[j]);
+      }
+    }
+  }
+  return ScatteringDataFieldSpectral(f_grid_,
+                                     t_grid_,
+                                     lon_inc_,
+                                     lat_inc,
+                                     sht,
+                                     data_new);
+}
+
 template <typename Scalar>
 ScatteringDataFieldFullySpectral<Scalar>
 ScatteringDataFieldSpectral<Scalar>::to_fully_spectral(
-    std::shared_ptr<sht::SHT> sht) const {
-  eigen::IndexArray<4> dimensions_loop = {n_freqs_,
-                                          n_temps_,
-                                          data_->dimension(4),
-                                          data_->dimension(5)};
+    std::shared_ptr<const sht::SHT> sht,
+    bool sparse) const {
+  if (sparse && (sht->get_m_max() > 0) && is_azimuthally_symmetric_inc()) {
+    sht = sht::SHTProvider::get(sht->get_l_max(),
+                                0,
+                                sht->get_n_longitudes(),
+                                sht->get_n_latitudes());
+  }
   eigen::IndexArray<5> dimensions_new = {n_freqs_,
                                          n_temps_,
                                          sht->get_n_spectral_coeffs_cmplx(),
@@ -1968,24 +2634,184 @@ ScatteringDataFieldSpectral<Scalar>::to_fully_spectral(
                                          data_->dimension(5)};
   using CmplxDataTensor = eigen::Tensor<std::complex<Scalar>, 5>;
   auto data_new = std::make_shared<CmplxDataTensor>(dimensions_new);
-  for (eigen::DimensionCounter<4> i{dimensions_loop}; i; ++i) {
-    eigen::get_subvector<2>(*data_new, i.coordinates) =
-        sht->transform_cmplx(eigen::get_submatrix<2, 3>(*data_, i.coordinates));
-  }
-  return ScatteringDataFieldFullySpectral<Scalar>(f_grid_,
-                                                  t_grid_,
-                                                  sht,
-                                                  sht_scat_,
-                                                  data_new);
+
+  // For each frequency and temperature, the scattering-angle coefficients
+  // and stokes components are the innermost dimensions of both input and
+  // output, so they are transformed as one batch of fields.
+  Index n_outer = n_freqs_ * n_temps_;
+  Index n_fields = data_->dimension(4) * data_->dimension(5);
+  eigen::IndexArray<3> dimensions_in = {data_->dimension(2),
+                                        data_->dimension(3),
+                                        n_fields};
+  eigen::IndexArray<2> dimensions_out = {data_new->dimension(2), n_fields};
+  Index stride_in = dimensions_in[0] * dimensions_in[1] * dimensions_in[2];
+  Index stride_out = dimensions_out[0] * dimensions_out[1];
+
+  auto workspace = sht->create_workspace();
+  for (Index i = 0; i < n_outer; ++i) {
+    sht->transform_cmplx_batch(
+        eigen::TensorMap<std::complex<Scalar>, 2>(
+            data_new->data() + i * stride_out,
+            dimensions_out),
+        eigen::ConstTensorMap<std::complex<Scalar>, 3>(
+            data_->data() + i * stride_in,
+            dimensions_in),
+        workspace);
+  }
+  auto result = ScatteringDataFieldFullySpectral<Scalar>(f_grid_,
+                                                         t_grid_,
+                                                         sht,
+                                                         sht_scat_,
+                                                         data_new);
+  if (sparse) {
+    return result.compact();
+  }
+  return result;
+}
+
+template <typename Scalar>
+Scalar ScatteringDataFieldSpectral<Scalar>::get_truncation_error(
+    Index l_max,
+    Index m_max) const {
+  auto power = get_relative_power_spectra();
+  auto l = sht_scat_->get_l_indices();
+  auto m = sht_scat_->get_m_indices();
+  Scalar error = 0.0;
+  for (Index i = 0; i < power.rows(); ++i) {
+    Scalar residual = 0.0;
+    for (Index j = 0; j < power.cols(); ++j) {
+      if ((l[j] > l_max) || (m[j] > m_max)) {
+        residual += power(i, j);
+      }
+    }
+    error = std::max(error, residual);
+  }
+  return sqrt(error);
+}
+
+template <typename Scalar>
+std::pair<ScatteringDataFieldSpectral<Scalar>, Scalar>
+ScatteringDataFieldSpectral<Scalar>::compress(Scalar tolerance) const {
+  Index l_max = sht_scat_->get_l_max();
+  Index m_max = sht_scat_->get_m_max();
+  if (l_max == 0) {
+    return {*this, 0.0};
+  }
+
+  // Bound the power of each (l, m) mode by its maximum over all expansions,
+  // so that the truncation can be determined from a single spectrum.
+  auto power = get_relative_power_spectra();
+  auto l = sht_scat_->get_l_indices();
+  auto m = sht_scat_->get_m_indices();
+  eigen::Matrix<Scalar> bound = eigen::Matrix<Scalar>::Zero(l_max + 1,
+                                                            m_max + 1);
+  for (Index j = 0; j < power.cols(); ++j) {
+    bound(l[j], m[j]) = power.col(j).maxCoeff();
+  }
+  Scalar total = bound.sum();
+  Scalar threshold = tolerance * tolerance;
+
+  Index l_best = l_max, m_best = m_max;
+  Index n_best = sht::SHT::calc_n_spectral_coeffs(l_max, m_max);
+  for (Index m_trunc = 0; m_trunc <= m_max; ++m_trunc) {
+    Scalar retained = 0.0;
+    for (Index l_trunc = 0; l_trunc <= l_max; ++l_trunc) {
+      retained += bound.row(l_trunc).head(std::min(l_trunc, m_trunc) + 1).sum();
+      // l_max = 0 is excluded since the trivial SHT stores the data value
+      // and not the coefficient of the expansion.
+      if ((l_trunc < m_trunc) || (l_trunc == 0)) {
+        continue;
+      }
+      if (total - retained <= threshold) {
+        Index n = sht::SHT::calc_n_spectral_coeffs(l_trunc, m_trunc);
+        if (n < n_best) {
+          l_best = l_trunc;
+          m_best = m_trunc;
+          n_best = n;
+        }
+        break;
+      }
+    }
+  }
+
+  return {to_spectral(l_best, m_best), get_truncation_error(l_best, m_best)};
+}
+
+template <typename Scalar>
+std::pair<Index, Index>
+ScatteringDataFieldFullySpectral<Scalar>::get_active_modes_inc(
+    Scalar relative_tolerance) const {
+  Index n_coeffs = data_->dimension(2);
+  Index n_outer = n_freqs_ * n_temps_;
+  Index n_inner = data_->dimension(3) * data_->dimension(4);
+  eigen::Vector<Scalar> max_abs = eigen::Vector<Scalar>::Zero(n_coeffs);
+  const std::complex<Scalar> *data = data_->data();
+  for (Index i = 0; i < n_outer; ++i) {
+    for (Index j = 0; j < n_coeffs; ++j) {
+      const std::complex<Scalar> *block = data + (i * n_coeffs + j) * n_inner;
+      for (Index k = 0; k < n_inner; ++k) {
+        max_abs[j] = std::max(max_abs[j], std::abs(block[k]));
+      }
+    }
+  }
+  Scalar threshold = relative_tolerance * max_abs.maxCoeff();
+
+  // Complex coefficients are ordered by l and then m = -min(l, m_max), ...
+  Index l_max = sht_inc_->get_l_max();
+  Index m_max = sht_inc_->get_m_max();
+  Index l_active = 0, m_active = 0;
+  Index index = 0;
+  for (Index l = 0; l <= l_max; ++l) {
+    Index h = std::min(l, m_max);
+    for (Index m = -h; m <= h; ++m) {
+      if (max_abs[index] > threshold) {
+        l_active = l;
+        m_active = std::max(m_active, std::abs(m));
+      }
+      ++index;
+    }
+  }
+  return {l_active, m_active};
+}
+
+template <typename Scalar>
+ScatteringDataFieldFullySpectral<Scalar>
+ScatteringDataFieldFullySpectral<Scalar>::compact(
+    Scalar relative_tolerance) const {
+  auto active = get_active_modes_inc(relative_tolerance);
+  // A trivial SHT (l_max == 0) stores data values instead of coefficients
+  // and has a single grid point, so at least l_max = 1 is kept.
+  Index l_max = std::min(std::max<Index>(active.first, 1),
+                         sht_inc_->get_l_max());
+  Index m_max = std::min(l_max, active.second);
+  if ((l_max == sht_inc_->get_l_max()) && (m_max == sht_inc_->get_m_max())) {
+    return *this;
+  }
+  auto sht_inc = sht::SHTProvider::get(l_max,
+                                       m_max,
+                                       sht_inc_->get_n_longitudes(),
+                                       sht_inc_->get_n_latitudes());
+  auto map = sht::SpectralIndexMap::get(*sht_inc_, *sht_inc, true);
+  eigen::IndexArray<5> dimensions_new = {n_freqs_,
+                                         n_temps_,
+                                         sht_inc->get_n_spectral_coeffs_cmplx(),
+                                         data_->dimension(3),
+                                         data_->dimension(4)};
+  auto data_new = std::make_shared<DataTensor>(dimensions_new);
+  map->copy(data_new->data(),
+            data_->data(),
+            n_freqs_ * n_temps_,
+            data_->dimension(3) * data_->dimension(4));
+  return ScatteringDataFieldFullySpectral(f_grid_,
+                                          t_grid_,
+                                          sht_inc,
+                                          sht_scat_,
+                                          data_new);
 }
 
 template <typename Scalar>
 ScatteringDataFieldSpectral<Scalar>
 ScatteringDataFieldFullySpectral<Scalar>::to_spectral() const {
-  eigen::IndexArray<4> dimensions_loop = {n_freqs_,
-                                          n_temps_,
-                                          data_->dimension(3),
-                                          data_->dimension(4)};
   eigen::IndexArray<6> dimensions_new = {n_freqs_,
                                          n_temps_,
                                          sht_inc_->get_n_longitudes(),
@@ -1994,14 +2820,32 @@ ScatteringDataFieldFullySpectral<Scalar>::to_spectral() const {
                                          data_->dimension(4)};
   using CmplxDataTensor = eigen::Tensor<std::complex<Scalar>, 6>;
   auto data_new = std::make_shared<CmplxDataTensor>(dimensions_new);
-  for (eigen::DimensionCounter<4> i{dimensions_loop}; i; ++i) {
-    eigen::get_submatrix<2, 3>(*data_new, i.coordinates) =
-        sht_inc_->synthesize_cmplx(
-            eigen::get_subvector<2>(*data_, i.coordinates));
-  }
 
-  auto lon_inc_ = std::make_shared<Vector>(sht_inc_->get_longitude_grid());
-  auto lat_inc_ = std::make_shared<sht::SHT::LatGrid>(sht_inc_->get_latitude_grid());
+  Index n_outer = n_freqs_ * n_temps_;
+  Index n_fields = data_->dimension(3) * data_->dimension(4);
+  eigen::IndexArray<2> dimensions_in = {data_->dimension(2), n_fields};
+  eigen::IndexArray<3> dimensions_out = {data_new->dimension(2),
+                                         data_new->dimension(3),
+                                         n_fields};
+  Index stride_in = dimensions_in[0] * dimensions_in[1];
+  Index stride_out = dimensions_out[0] * dimensions_out[1] * dimensions_out[2];
+
+  auto workspace = sht_inc_->create_workspace();
+  for (Index i = 0; i < n_outer; ++i) {
+    sht_inc_->synthesize_cmplx_batch(
+        eigen::TensorMap<std::complex<Scalar>, 3>(
+            data_new->data() + i * stride_out,
+            dimensions_out),
+        eigen::ConstTensorMap<std::complex<Scalar>, 2>(
+            data_->data() + i * stride_in,
+            dimensions_in),
+        workspace);
+  }
+
+  auto lon_inc_ = std::make_shared<Vector>(
+      sht_inc_->get_longitude_grid().cast<Scalar>());
+  auto lat_inc_ = std::make_shared<sht::LatGrid<Scalar>>(
+      (sht_inc_->get_l_max() > 0) ? sht_inc_->get_n_latitudes() : 1);
 
   return ScatteringDataFieldSpectral<Scalar>(f_grid_,
                                              t_grid_,
@@ -4,10 +4,15 @@
 #include <fftw3.h>
 #include <shtns.h>
 
+#include <algorithm>
+#include <array>
 #include <complex>
 #include <iostream>
+#include <list>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <vector>
 
 #include "Eigen/Dense"
 
@@ -29,6 +34,10 @@ namespace sht {
 
 using scattering::eigen::Index;
 
+/// The Fejer-quadrature latitude grid used by SHTns for given precision.
+template <typename Scalar>
+using LatGrid = QuadratureLatitudeGrid<FejerQuadrature<Scalar>, Scalar>;
+
 
 /** FFTW coefficient array
  *
@@ -42,18 +51,227 @@ class FFTWArray {
   FFTWArray() {}
   FFTWArray(Index n);
   operator Numeric *() const { return ptr_.get(); }
+  Numeric *get() const { return ptr_.get(); }
 
  private:
   std::shared_ptr<Numeric> ptr_ = nullptr;
 };
 
+////////////////////////////////////////////////////////////////////////////////
+// SHTns configurations
+////////////////////////////////////////////////////////////////////////////////
+/** Shared SHTns configuration.
+ *
+ * Reference-counted handle to an SHTns configuration. The configuration is
+ * destroyed using shtns_destroy when the last handle referencing it goes out
+ * of scope. Converts implicitly to shtns_cfg so that it can be passed
+ * directly to the SHTns transform functions.
+ */
+class ShtnsConfig {
+ public:
+  ShtnsConfig() {}
+  ShtnsConfig(shtns_cfg cfg);
+
+  operator shtns_cfg() const { return cfg_.get(); }
+  shtns_cfg operator->() const { return cfg_.get(); }
+
+ private:
+  std::shared_ptr<shtns_info> cfg_ = nullptr;
+};
+
+/** Cache of SHTns configurations.
+ *
+ * Initializing SHTns for a given grid requires planning the FFTs and
+ * computing the Legendre tables, which is expensive. The ShtnsHandle
+ * therefore keeps a bounded, least-recently-used (LRU) cache of
+ * configurations keyed by (l_max, m_max, n_lon, n_lat, n_threads), so that
+ * alternating between different grids only costs a lookup. The number of
+ * threads is part of the key because SHTns fixes it when the configuration
+ * is created.
+ *
+ * Access to the cache is synchronized, so configurations can be requested
+ * from multiple threads concurrently. Evicted configurations remain valid
+ * until the last handle referencing them is released.
+ */
+// pxx :: export
 class ShtnsHandle {
  public:
- static shtns_cfg get(Index l_max, Index m_max, Index n_lon, Index n_lat);
+  using Config = std::array<Index, 5>;
+
+  // pxx :: hide
+  /** Get SHTns configuration for given grid.
+   * @param l_max The maximum degree of the SHT.
+   * @param m_max The maximum order of the SHT.
+   * @param n_lon The number of longitude grid points.
+   * @param n_lat The number of co-latitude grid points.
+   * @param n_threads The number of OpenMP threads SHTns should use for a
+   * single transform.
+   * @return Handle to the SHTns configuration.
+   */
+  static ShtnsConfig get(Index l_max,
+                         Index m_max,
+                         Index n_lon,
+                         Index n_lat,
+                         Index n_threads = 1);
+
+  /** Set maximum number of cached configurations.
+   *
+   * If the cache currently holds more configurations than the new
+   * capacity, the least recently used ones are evicted.
+   *
+   * @param capacity The maximum number of configurations to keep.
+   */
+  static void set_capacity(size_t capacity);
+  /// The maximum number of cached configurations.
+  static size_t get_capacity();
+  /// The number of currently cached configurations.
+  static size_t get_size();
+
+  /// The number of requests that were served from the cache.
+  static size_t get_hits();
+  /// The number of requests that required creating a new configuration.
+  static size_t get_misses();
+  /// The number of configurations that were evicted from the cache.
+  static size_t get_evictions();
+  /// Reset hit, miss and eviction counters.
+  static void reset_statistics();
+
+  /// Remove all configurations from the cache.
+  static void clear();
+
+ private:
+  friend class ShtnsConfig;
+
+  static void evict(size_t capacity);
+
+  using LruList = std::list<Config>;
+  struct Entry {
+    ShtnsConfig cfg;
+    LruList::iterator position;
+  };
+
+  static std::recursive_mutex mutex_;
+  static size_t capacity_;
+  static size_t hits_, misses_, evictions_;
+  static LruList lru_;
+  static std::map<Config, Entry> entries_;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// SHTWorkspace
+////////////////////////////////////////////////////////////////////////////////
+/** Scratch buffers for spherical harmonics transforms.
+ *
+ * Holds the FFTW-aligned arrays that SHTns reads from and writes to during
+ * a transform. Since the SHTns configurations themselves are read-only during
+ * transforms, the same SHT object can be used concurrently from several
+ * threads as long as each thread uses its own workspace.
+ */
+class SHTWorkspace {
+ public:
+  SHTWorkspace() {}
+  /**
+   * Allocate workspace.
+   * @param n_spectral_coeffs The number of spectral coefficients for real
+   * transforms.
+   * @param n_spectral_coeffs_cmplx The number of spectral coefficients for
+   * complex transforms.
+   * @param n_spatial_coeffs The number of points of the spatial grid.
+   */
+  SHTWorkspace(Index n_spectral_coeffs,
+               Index n_spectral_coeffs_cmplx,
+               Index n_spatial_coeffs)
+      : spectral_coeffs(n_spectral_coeffs),
+        spectral_coeffs_cmplx(n_spectral_coeffs_cmplx),
+        cmplx_spatial_coeffs(n_spatial_coeffs),
+        spatial_coeffs(n_spatial_coeffs) {}
+
+  FFTWArray<std::complex<double>> spectral_coeffs, spectral_coeffs_cmplx,
+      cmplx_spatial_coeffs;
+  FFTWArray<double> spatial_coeffs;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// LegendreExpansion
+////////////////////////////////////////////////////////////////////////////////
+/** Legendre series evaluation for azimuthally symmetric fields.
+ *
+ * For fields that don't depend on the longitude (m_max == 0), the SH
+ * expansion degenerates to a Legendre series. This class holds a table of
+ * the (SHTns-normalized) Legendre polynomials P_l(cos(theta)) for a fixed set
+ * of co-latitudes, so that evaluating many coefficient vectors on the same
+ * grid reduces to a dense matrix product.
+ */
+class LegendreExpansion {
+ public:
+  /**
+   * Create Legendre table.
+   * @param l_max The maximum degree of the expansion.
+   * @param cos_thetas Vector containing the cosines of the co-latitudes
+   * at which to evaluate the series.
+   */
+  LegendreExpansion(Index l_max, const eigen::Vector<double> &cos_thetas);
+
+  /** Get cached Legendre table.
+   *
+   * Tables are cached per combination of l_max and co-latitude grid, so
+   * repeated evaluations on the same grid reuse the same table.
+   *
+   * @param l_max The maximum degree of the expansion.
+   * @param cos_thetas Vector containing the cosines of the co-latitudes
+   * at which to evaluate the series.
+   * @return Shared pointer to the Legendre table.
+   */
+  static std::shared_ptr<const LegendreExpansion> get(
+      Index l_max,
+      const eigen::Vector<double> &cos_thetas);
+
+  /// The maximum degree of the expansion.
+  Index get_l_max() const { return l_max_; }
+  /// The number of co-latitudes.
+  Index get_n_points() const { return table_.rows(); }
+  /// Table of shape (n_points, l_max + 1) of Legendre polynomial values.
+  const eigen::Matrix<double> &get_table() const { return table_; }
+
+  /** Evaluate Legendre series.
+   * @param coeffs Vector containing the l_max + 1 expansion coefficients.
+   * @return Vector containing the values of the series at the co-latitudes.
+   */
+  eigen::Vector<double> evaluate(const SpectralCoeffsRef &coeffs) const;
+
+  /** Evaluate many Legendre series at once.
+   *
+   * @param output Rank-3 tensor of shape (n_lon, n_points, N) to which the
+   * values are written. Since the fields are azimuthally symmetric, the
+   * values are the same for all n_lon longitudes.
+   * @param coeffs Rank-2 tensor of shape (l_max + 1, N) containing the
+   * expansion coefficients of the N fields.
+   */
+  void evaluate(eigen::TensorMap<double, 3> output,
+                eigen::ConstTensorMap<std::complex<double>, 2> coeffs) const;
+
+  /** Evaluate many Legendre series stored in single precision.
+   *
+   * The series are evaluated in double precision and the results rounded
+   * to single precision.
+   *
+   * @param output Rank-3 tensor of shape (n_lon, n_points, N) to which the
+   * values are written.
+   * @param coeffs Rank-2 tensor of shape (l_max + 1, N) containing the
+   * expansion coefficients of the N fields.
+   */
+  void evaluate(eigen::TensorMap<float, 3> output,
+                eigen::ConstTensorMap<std::complex<float>, 2> coeffs) const;
 
  private:
-  static std::array<Index, 4> current_config_;
-  static shtns_cfg shtns_;
+  static constexpr size_t cache_size_ = 32;
+  static std::mutex mutex_;
+  static std::map<std::pair<Index, std::vector<double>>,
+                  std::shared_ptr<const LegendreExpansion>>
+      cache_;
+
+  Index l_max_;
+  eigen::Matrix<double> table_;
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -124,6 +342,36 @@ class SHT {
 
   static std::array<Index, 4> get_params(Index n_lon, Index n_lat);
 
+  /** Set number of threads to use for SH transforms.
+   *
+   * The threads are used either within each transform, using SHTns'
+   * OpenMP kernels, or to transform several fields concurrently. Which of
+   * the two is used is decided based on l_max and the number of fields
+   * to transform, see get_n_threads_intra(). Has no effect if the library
+   * was built without OpenMP support.
+   *
+   * @param n_threads The number of threads. Values smaller than one
+   * select the number of threads reported by OpenMP.
+   */
+  static void set_n_threads(Index n_threads);
+
+  /// The number of threads used for SH transforms.
+  static Index get_n_threads();
+
+  /** Set l_max threshold for intra-transform threading.
+   *
+   * Transforms with l_max at or above this value are parallelized
+   * internally by SHTns. For smaller transforms, the threading overhead
+   * outweighs the gain so that it is more efficient to transform
+   * several fields concurrently.
+   *
+   * @param l_max The minimum l_max for intra-transform threading.
+   */
+  static void set_intra_threading_l_max(Index l_max);
+
+  /// The minimum l_max for intra-transform threading.
+  static Index get_intra_threading_l_max();
+
   /**
    * Create a spherical harmonics transformation object.
    *
@@ -158,28 +406,67 @@ class SHT {
   /** Return latitude grid used by SHTns.
    * @return Eigen vector containing the latitude grid in radians.
    */
-  LatGrid get_latitude_grid();
+  LatGrid get_latitude_grid() const;
 
   /** Return co-latitude grid used by SHTns.
    * @return Eigen vector containing the co-latitude grid.
    */
-  Vector get_colatitude_grid();
+  Vector get_colatitude_grid() const;
 
-  Vector get_longitude_grid();
+  Vector get_longitude_grid() const;
 
   /** L-indices of the SHT modes.
    *
    * @return A vector of indices containing the l-value corresponding to each
    * element in a spectral coefficient vector.
    */
-  IndexVector get_l_indices();
+  IndexVector get_l_indices() const;
 
   /** M-indices of the SHT modes.
    *
    * @return A vector of indices containing the m-value corresponding to each
    * element in a spectral coefficient vector.
    */
-  IndexVector get_m_indices();
+  IndexVector get_m_indices() const;
+
+  /** Weights for the evaluation of an expansion at a pole.
+   *
+   * Only the m = 0 modes contribute to the value of an expansion at the
+   * poles. Since these are stored first, the value of a real expansion
+   * with coefficients c at the pole is given by the dot product of the
+   * returned weights and the first l_max + 1 elements of c.
+   *
+   * @param south If true, the weights for the evaluation at theta = pi are
+   * returned, otherwise for theta = 0.
+   * @return Vector of length l_max + 1 containing the values of the m = 0
+   * basis functions at the pole.
+   */
+  Vector get_pole_weights(bool south) const;
+
+  /** Number of threads to use within a single transform.
+   *
+   * Intra-transform threading is used when l_max is large or when there
+   * are fewer fields than threads. Inside an OpenMP parallel region,
+   * transforms are always single threaded.
+   *
+   * @param n_fields The number of fields that are to be transformed.
+   * @return The number of threads SHTns should use for each transform.
+   */
+  Index get_n_threads_intra(Index n_fields) const;
+
+  /** Number of threads to use to transform several fields concurrently.
+   * @param n_fields The number of fields that are to be transformed.
+   * @return The number of threads over which to distribute the fields.
+   */
+  Index get_n_threads_across(Index n_fields) const;
+
+  // pxx :: hide
+  /** Create workspace for reentrant transforms.
+   *
+   * @return A workspace with buffers large enough for the transforms
+   * of this SHT.
+   */
+  SHTWorkspace create_workspace() const;
 
   /**
    * Copy spatial field into the array that holds spatial data for
@@ -259,12 +546,12 @@ class SHT {
   /**
    * @return The maximum degree l of the SHT transformation.
    */
-  Index get_l_max() { return l_max_; }
+  Index get_l_max() const { return l_max_; }
 
   /**
    * @return The maximum order m of the SHT transformation.
    */
-  Index get_m_max() { return m_max_; }
+  Index get_m_max() const { return m_max_; }
 
   /**
    * Return content of the array that holds spectral data for
@@ -324,23 +611,316 @@ class SHT {
    */
   CmplxGridCoeffs synthesize_cmplx(const SpectralCoeffsRef &m);
 
+  // pxx :: hide
+  /** Apply forward SHT Transform using given workspace.
+   *
+   * In contrast to transform(m), this method does not modify the SHT object
+   * and can thus be called concurrently from different threads, provided
+   * that each thread uses a separate workspace.
+   *
+   * @param m GridCoeffs containing the data. Row indices should correspond to
+   * longitudes (azimuth angle) and columns to latitudes (zenith angle).
+   * @param workspace Workspace created using create_workspace().
+   * @return Coefficient vector containing the spherical harmonics coefficients.
+   */
+  SpectralCoeffs transform(const GridCoeffsRef &m,
+                           SHTWorkspace &workspace) const;
+
+  // pxx :: hide
+  /** Apply forward SHT Transform to complex data using given workspace.
+   * @param m CmplxGridCoeffs containing the data.
+   * @param workspace Workspace created using create_workspace().
+   * @return Coefficient vector containing the spherical harmonics coefficients.
+   */
+  SpectralCoeffs transform_cmplx(const CmplxGridCoeffsRef &m,
+                                 SHTWorkspace &workspace) const;
+
+  // pxx :: hide
+  /** Apply inverse SHT Transform using given workspace.
+   * @param m SpectralCoeffs The spherical harmonics coefficients
+   * representing the data.
+   * @param workspace Workspace created using create_workspace().
+   * @return GridCoeffs containing the spatial data.
+   */
+  GridCoeffs synthesize(const SpectralCoeffsRef &m,
+                        SHTWorkspace &workspace) const;
+
+  // pxx :: hide
+  /** Apply inverse SHT Transform for complex data using given workspace.
+   * @param m SpectralCoeffs The spherical harmonics coefficients
+   * representing the data.
+   * @param workspace Workspace created using create_workspace().
+   * @return CmplxGridCoeffs containing the spatial data.
+   */
+  CmplxGridCoeffs synthesize_cmplx(const SpectralCoeffsRef &m,
+                                   SHTWorkspace &workspace) const;
+
+  // pxx :: hide
+  /** Apply forward SHT transform writing into given output.
+   *
+   * Writes the spherical harmonics coefficients directly into the
+   * destination, e.g. a sub-vector of a tensor obtained using
+   * eigen::get_subvector. If the destination is contiguous and suitably
+   * aligned, SHTns writes to it directly, otherwise the coefficients are
+   * copied from the workspace. No memory is allocated.
+   *
+   * @param output Vector to which the spherical harmonics coefficients are
+   * written.
+   * @param m Matrix containing the spatial field. Row indices should
+   * correspond to longitudes (azimuth angle) and columns to latitudes (zenith
+   * angle).
+   * @param workspace Workspace created using create_workspace().
+   */
+  void transform(eigen::VectorMapDynamic<std::complex<double>> output,
+                 eigen::ConstMatrixMapDynamic<double> m,
+                 SHTWorkspace &workspace) const;
+
+  // pxx :: hide
+  /** Apply forward SHT transform to complex data writing into given output.
+   * @param output Vector to which the spherical harmonics coefficients are
+   * written.
+   * @param m Matrix containing the complex spatial field.
+   * @param workspace Workspace created using create_workspace().
+   */
+  void transform_cmplx(eigen::VectorMapDynamic<std::complex<double>> output,
+                       eigen::ConstMatrixMapDynamic<std::complex<double>> m,
+                       SHTWorkspace &workspace) const;
+
+  // pxx :: hide
+  /** Apply inverse SHT transform writing into given output.
+   *
+   * If the destination is a contiguous, suitably aligned longitude-major
+   * matrix, SHTns writes the spatial field to it directly.
+   *
+   * @param output Matrix to which the spatial field is written.
+   * @param m Vector containing the spherical harmonics coefficients.
+   * @param workspace Workspace created using create_workspace().
+   */
+  void synthesize(eigen::MatrixMapDynamic<double> output,
+                  eigen::ConstVectorMapDynamic<std::complex<double>> m,
+                  SHTWorkspace &workspace) const;
+
+  // pxx :: hide
+  /** Apply inverse SHT transform to complex data writing into given output.
+   * @param output Matrix to which the complex spatial field is written.
+   * @param m Vector containing the spherical harmonics coefficients.
+   * @param workspace Workspace created using create_workspace().
+   */
+  void synthesize_cmplx(eigen::MatrixMapDynamic<std::complex<double>> output,
+                        eigen::ConstVectorMapDynamic<std::complex<double>> m,
+                        SHTWorkspace &workspace) const;
+
+  // pxx :: hide
+  /** Apply forward SHT transform to single-precision data.
+   *
+   * SHTns only supports double precision, so the field is converted while
+   * it is copied into the workspace and the coefficients are rounded when
+   * they are copied into the output.
+   *
+   * @param output Vector to which the spherical harmonics coefficients are
+   * written.
+   * @param m Matrix containing the spatial field.
+   * @param workspace Workspace created using create_workspace().
+   */
+  void transform(eigen::VectorMapDynamic<std::complex<float>> output,
+                 eigen::ConstMatrixMapDynamic<float> m,
+                 SHTWorkspace &workspace) const;
+
+  // pxx :: hide
+  /** Apply forward SHT transform to single-precision complex data.
+   * @param output Vector to which the spherical harmonics coefficients are
+   * written.
+   * @param m Matrix containing the complex spatial field.
+   * @param workspace Workspace created using create_workspace().
+   */
+  void transform_cmplx(eigen::VectorMapDynamic<std::complex<float>> output,
+                       eigen::ConstMatrixMapDynamic<std::complex<float>> m,
+                       SHTWorkspace &workspace) const;
+
+  // pxx :: hide
+  /** Apply inverse SHT transform to single-precision data.
+   * @param output Matrix to which the spatial field is written.
+   * @param m Vector containing the spherical harmonics coefficients.
+   * @param workspace Workspace created using create_workspace().
+   */
+  void synthesize(eigen::MatrixMapDynamic<float> output,
+                  eigen::ConstVectorMapDynamic<std::complex<float>> m,
+                  SHTWorkspace &workspace) const;
+
+  // pxx :: hide
+  /** Apply inverse SHT transform to single-precision complex data.
+   * @param output Matrix to which the complex spatial field is written.
+   * @param m Vector containing the spherical harmonics coefficients.
+   * @param workspace Workspace created using create_workspace().
+   */
+  void synthesize_cmplx(eigen::MatrixMapDynamic<std::complex<float>> output,
+                        eigen::ConstVectorMapDynamic<std::complex<float>> m,
+                        SHTWorkspace &workspace) const;
+
+  // pxx :: hide
+  /** Apply forward SHT transform to a batch of fields.
+   *
+   * Transforms N spatial fields at once, writing the spectral coefficients
+   * directly into the given output tensor. The SHTns configuration is looked
+   * up only once and no memory is allocated during the transform.
+   *
+   * @param output Rank-2 tensor of shape (n_spectral_coeffs, N) to which the
+   * spherical harmonics coefficients of the fields are written.
+   * @param fields Rank-3 tensor of shape (n_lon, n_lat, N) containing the
+   * spatial fields.
+   * @param workspace Workspace created using create_workspace().
+   */
+  void transform_batch(eigen::TensorMap<std::complex<double>, 2> output,
+                       eigen::ConstTensorMap<double, 3> fields,
+                       SHTWorkspace &workspace) const;
+
+  // pxx :: hide
+  /** Apply forward SHT transform to a batch of single-precision fields.
+   *
+   * The fields are converted to double precision while they are copied
+   * into the workspace, so the transform itself is as accurate as for
+   * double-precision data. Only the stored coefficients are rounded.
+   *
+   * @param output Rank-2 tensor of shape (n_spectral_coeffs, N) to which the
+   * spherical harmonics coefficients of the fields are written.
+   * @param fields Rank-3 tensor of shape (n_lon, n_lat, N) containing the
+   * spatial fields.
+   * @param workspace Workspace created using create_workspace().
+   */
+  void transform_batch(eigen::TensorMap<std::complex<float>, 2> output,
+                       eigen::ConstTensorMap<float, 3> fields,
+                       SHTWorkspace &workspace) const;
+
+  /** Apply forward SHT transform to a batch of fields.
+   *
+   * @param fields Rank-3 tensor of shape (n_lon, n_lat, N) containing the
+   * spatial fields.
+   * @return Rank-2 tensor of shape (n_spectral_coeffs, N) containing
+   * the spherical harmonics coefficients of the fields.
+   */
+  eigen::Tensor<std::complex<double>, 2> transform_batch(
+      const eigen::Tensor<double, 3> &fields) const;
+
+  // pxx :: hide
+  /** Apply inverse SHT transform to a batch of fields.
+   *
+   * @param output Rank-3 tensor of shape (n_lon, n_lat, N) to which the
+   * spatial fields are written.
+   * @param coeffs Rank-2 tensor of shape (n_spectral_coeffs, N) containing
+   * the spherical harmonics coefficients of the fields.
+   * @param workspace Workspace created using create_workspace().
+   */
+  void synthesize_batch(eigen::TensorMap<double, 3> output,
+                        eigen::ConstTensorMap<std::complex<double>, 2> coeffs,
+                        SHTWorkspace &workspace) const;
+
+  // pxx :: hide
+  /** Apply inverse SHT transform to a batch of single-precision fields.
+   *
+   * @param output Rank-3 tensor of shape (n_lon, n_lat, N) to which the
+   * spatial fields are written.
+   * @param coeffs Rank-2 tensor of shape (n_spectral_coeffs, N) containing
+   * the spherical harmonics coefficients of the fields.
+   * @param workspace Workspace created using create_workspace().
+   */
+  void synthesize_batch(eigen::TensorMap<float, 3> output,
+                        eigen::ConstTensorMap<std::complex<float>, 2> coeffs,
+                        SHTWorkspace &workspace) const;
+
+  /** Apply inverse SHT transform to a batch of fields.
+   *
+   * @param coeffs Rank-2 tensor of shape (n_spectral_coeffs, N) containing
+   * the spherical harmonics coefficients of the fields.
+   * @return Rank-3 tensor of shape (n_lon, n_lat, N) containing the
+   * spatial fields.
+   */
+  eigen::Tensor<double, 3> synthesize_batch(
+      const eigen::Tensor<std::complex<double>, 2> &coeffs) const;
+
+  // pxx :: hide
+  /** Apply forward SHT transform to a batch of complex fields.
+   *
+   * Fields whose imaginary part is zero are transformed using the cheaper
+   * real transform, as in transform_cmplx().
+   *
+   * @param output Rank-2 tensor of shape (n_spectral_coeffs_cmplx, N) to
+   * which the spherical harmonics coefficients of the fields are written.
+   * @param fields Rank-3 tensor of shape (n_lon, n_lat, N) containing the
+   * spatial fields.
+   * @param workspace Workspace created using create_workspace().
+   */
+  void transform_cmplx_batch(
+      eigen::TensorMap<std::complex<double>, 2> output,
+      eigen::ConstTensorMap<std::complex<double>, 3> fields,
+      SHTWorkspace &workspace) const;
+
+  // pxx :: hide
+  /** Apply forward SHT transform to a batch of single-precision complex
+   * fields.
+   *
+   * @param output Rank-2 tensor of shape (n_spectral_coeffs_cmplx, N) to
+   * which the spherical harmonics coefficients of the fields are written.
+   * @param fields Rank-3 tensor of shape (n_lon, n_lat, N) containing the
+   * spatial fields.
+   * @param workspace Workspace created using create_workspace().
+   */
+  void transform_cmplx_batch(
+      eigen::TensorMap<std::complex<float>, 2> output,
+      eigen::ConstTensorMap<std::complex<float>, 3> fields,
+      SHTWorkspace &workspace) const;
+
+  // pxx :: hide
+  /** Apply inverse SHT transform to a batch of complex fields.
+   *
+   * @param output Rank-3 tensor of shape (n_lon, n_lat, N) to which the
+   * spatial fields are written.
+   * @param coeffs Rank-2 tensor of shape (n_spectral_coeffs_cmplx, N)
+   * containing the spherical harmonics coefficients of the fields.
+   * @param workspace Workspace created using create_workspace().
+   */
+  void synthesize_cmplx_batch(
+      eigen::TensorMap<std::complex<double>, 3> output,
+      eigen::ConstTensorMap<std::complex<double>, 2> coeffs,
+      SHTWorkspace &workspace) const;
+
+  // pxx :: hide
+  /** Apply inverse SHT transform to a batch of single-precision complex
+   * fields.
+   *
+   * @param output Rank-3 tensor of shape (n_lon, n_lat, N) to which the
+   * spatial fields are written.
+   * @param coeffs Rank-2 tensor of shape (n_spectral_coeffs_cmplx, N)
+   * containing the spherical harmonics coefficients of the fields.
+   * @param workspace Workspace created using create_workspace().
+   */
+  void synthesize_cmplx_batch(
+      eigen::TensorMap<std::complex<float>, 3> output,
+      eigen::ConstTensorMap<std::complex<float>, 2> coeffs,
+      SHTWorkspace &workspace) const;
+
   /** Evaluate spectral representation at given point.
+   *
+   * Points are grouped by co-latitude so that the associated Legendre
+   * functions are evaluated only once per distinct co-latitude. The
+   * longitude dependency is then synthesized for all points of a group
+   * at once.
    *
    * @param m Spectral coefficient vector containing the SH coefficients.
-   * @param points 2-row matrix containing the points (lon, lat) at which
+   * @param points 2-column matrix containing the points (lon, lat) at which
    * to evaluate the function.
    * @return A vector containing the values corresponding to the points
    * in points.
    */
   eigen::Vector<double> evaluate(
       const SpectralCoeffsRef &m,
-      const eigen::MatrixFixedRows<double, 2> &points);
+      const eigen::MatrixFixedRows<double, 2> &points) const;
 
   /** Evaluate 1D spectral representation at given point.
    *
    * This method covers the special case of 1D data that varies
    * only along latitudes. In this case the SH transform degenerates
-   * to a Legendre transform.
+   * to a Legendre transform, which is evaluated using a cached
+   * LegendreExpansion table.
    *
    * @param m Spectral coefficient vector containing the SH coefficients.
    * @param Vector containing the latitudes within [0, PI] to evaluate the
@@ -349,38 +929,408 @@ class SHT {
    * in points.
    */
   eigen::Vector<double> evaluate(const SpectralCoeffsRef &m,
-                                 const eigen::Vector<double> &thetas);
+                                 const eigen::Vector<double> &thetas) const;
+
+  /** Rotate spectral representation around the z-axis.
+   *
+   * @param m Spectral coefficient vector containing the SH coefficients.
+   * @param alpha The rotation angle in radians.
+   * @return The SH coefficients of the rotated field.
+   */
+  SpectralCoeffs rotate_z(const SpectralCoeffsRef &m, double alpha) const;
+
+  /** Rotate spectral representation around the y-axis.
+   *
+   * Rotations that are not around the z-axis mix coefficients with
+   * different m, so this requires m_max == l_max.
+   *
+   * @param m Spectral coefficient vector containing the SH coefficients.
+   * @param beta The rotation angle in radians.
+   * @return The SH coefficients of the rotated field.
+   */
+  SpectralCoeffs rotate_y(const SpectralCoeffsRef &m, double beta) const;
+
+  /** Rotate spectral representation by given Euler angles.
+   *
+   * Applies the rotation defined by the ZYZ Euler angles alpha, beta, gamma
+   * directly to the SH coefficients, i.e. by applying the corresponding
+   * Wigner-d matrices. This avoids synthesizing and re-transforming the
+   * field on a spatial grid. Requires m_max == l_max.
+   *
+   * @param m Spectral coefficient vector containing the SH coefficients.
+   * @param alpha Angle of the final rotation around the z-axis.
+   * @param beta Angle of the rotation around the y-axis.
+   * @param gamma Angle of the first rotation around the z-axis.
+   * @return The SH coefficients of the rotated field.
+   */
+  SpectralCoeffs rotate(const SpectralCoeffsRef &m,
+                        double alpha,
+                        double beta,
+                        double gamma) const;
+
+  // pxx :: hide
+  /** Rotate spectral representation in place.
+   *
+   * @param m Map to the SH coefficients to rotate. Will be overwritten with
+   * the coefficients of the rotated field.
+   * @param alpha Angle of the final rotation around the z-axis.
+   * @param beta Angle of the rotation around the y-axis.
+   * @param gamma Angle of the first rotation around the z-axis.
+   */
+  void rotate(eigen::VectorMapDynamic<std::complex<double>> m,
+              double alpha,
+              double beta,
+              double gamma) const;
 
  private:
+  /** SHTns configuration for this transform.
+   * @param n_fields The number of fields to transform, used to determine
+   * the number of threads SHTns should use.
+   */
+  ShtnsConfig get_shtns(Index n_fields = 1) const;
+
+  /** Transform complex field with vanishing imaginary part.
+   *
+   * Real fields are transformed using the real transform, which is about
+   * twice as fast as the complex transform, and the coefficients with m < 0
+   * are obtained from the conjugate symmetry of the coefficients.
+   *
+   * @param output Vector to which the complex SH coefficients are written.
+   * @param m The complex spatial field.
+   * @param workspace Workspace created using create_workspace().
+   * @return false if the field has a non-zero imaginary part, in which
+   * case nothing is written to the output.
+   */
+  template <typename OutputVector, typename InputMatrix>
+  bool transform_real_cmplx(OutputVector &&output,
+                            const InputMatrix &m,
+                            SHTWorkspace &workspace) const;
+
+  template <typename Scalar>
+  void transform_batch_impl(eigen::TensorMap<std::complex<Scalar>, 2> output,
+                            eigen::ConstTensorMap<Scalar, 3> fields,
+                            SHTWorkspace &workspace) const;
+
+  template <typename Scalar>
+  void synthesize_batch_impl(
+      eigen::TensorMap<Scalar, 3> output,
+      eigen::ConstTensorMap<std::complex<Scalar>, 2> coeffs,
+      SHTWorkspace &workspace) const;
+
+  template <typename Scalar>
+  void transform_cmplx_batch_impl(
+      eigen::TensorMap<std::complex<Scalar>, 2> output,
+      eigen::ConstTensorMap<std::complex<Scalar>, 3> fields,
+      SHTWorkspace &workspace) const;
+
+  template <typename Scalar>
+  void synthesize_cmplx_batch_impl(
+      eigen::TensorMap<std::complex<Scalar>, 3> output,
+      eigen::ConstTensorMap<std::complex<Scalar>, 2> coeffs,
+      SHTWorkspace &workspace) const;
+
   bool is_trivial_;
   Index l_max_, m_max_, n_lon_, n_lat_, n_spectral_coeffs_,
       n_spectral_coeffs_cmplx_;
 
-  sht::FFTWArray<std::complex<double>> spectral_coeffs_, spectral_coeffs_cmplx_,
-      cmplx_spatial_coeffs_;
-  sht::FFTWArray<double> spatial_coeffs_;
+  mutable SHTWorkspace workspace_;
+
+  static Index n_threads_;
+  static Index intra_threading_l_max_;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// SpectralIndexMap
+////////////////////////////////////////////////////////////////////////////////
+/** Map between the spectral coefficients of two SHTs.
+ *
+ * The coefficients of an SH expansion are stored in contiguous blocks
+ * of constant m (real transforms) or constant l (complex transforms).
+ * When coefficients of an expansion are accumulated into one with a
+ * different l_max or m_max, only the coefficients present in both
+ * expansions contribute. This class precomputes the corresponding pairs of
+ * contiguous blocks, so that remapping reduces to a small number of block
+ * additions that can be applied to whole tensors at once.
+ */
+class SpectralIndexMap {
+ public:
+  /// A contiguous block of coefficients present in both expansions.
+  struct Block {
+    Index source_start;
+    Index destination_start;
+    Index size;
+  };
+
+  /**
+   * Create index map.
+   * @param source The SHT of the coefficients to accumulate.
+   * @param destination The SHT of the coefficients to accumulate into.
+   * @param cmplx Whether to map the coefficients of the complex transform.
+   */
+  SpectralIndexMap(const SHT &source, const SHT &destination, bool cmplx);
+
+  /** Get cached index map.
+   * @param source The SHT of the coefficients to accumulate.
+   * @param destination The SHT of the coefficients to accumulate into.
+   * @param cmplx Whether to map the coefficients of the complex transform.
+   * @return Shared pointer to the index map for the given pair of SHTs.
+   */
+  static std::shared_ptr<const SpectralIndexMap> get(const SHT &source,
+                                                     const SHT &destination,
+                                                     bool cmplx = false);
+
+  /// The number of coefficients of the source expansion.
+  Index get_n_source_coeffs() const { return n_source_coeffs_; }
+  /// The number of coefficients of the destination expansion.
+  Index get_n_destination_coeffs() const { return n_destination_coeffs_; }
+  /// The blocks of coefficients present in both expansions.
+  const std::vector<Block> &get_blocks() const { return blocks_; }
+
+  /** Accumulate coefficients.
+   *
+   * Source and destination are contiguous tensors of shape
+   * (n_outer, n_coeffs, n_inner), where n_coeffs is the number of
+   * coefficients of the source and destination expansion, respectively.
+   *
+   * @param destination Pointer to the destination data.
+   * @param source Pointer to the source data.
+   * @param n_outer The product of the dimensions before the coefficient
+   * dimension.
+   * @param n_inner The product of the dimensions after the coefficient
+   * dimension.
+   */
+  template <typename Scalar>
+  void accumulate(Scalar *destination,
+                  const Scalar *source,
+                  Index n_outer,
+                  Index n_inner) const {
+    for (Index i = 0; i < n_outer; ++i) {
+      Scalar *dst = destination + i * n_destination_coeffs_ * n_inner;
+      const Scalar *src = source + i * n_source_coeffs_ * n_inner;
+      for (auto &b : blocks_) {
+        add(dst + b.destination_start * n_inner,
+            src + b.source_start * n_inner,
+            b.size * n_inner);
+      }
+    }
+  }
+
+  /** Accumulate coefficients of a two-dimensional expansion.
+   *
+   * Source and destination are contiguous tensors of shape
+   * (n_outer, n_coeffs_inc, n_coeffs_scat, n_inner), such as the data of
+   * fully-spectral scattering data.
+   *
+   * @param destination Pointer to the destination data.
+   * @param source Pointer to the source data.
+   * @param n_outer The product of the dimensions before the coefficient
+   * dimensions.
+   * @param map_inc Index map for the first coefficient dimension.
+   * @param map_scat Index map for the second coefficient dimension.
+   * @param n_inner The product of the dimensions after the coefficient
+   * dimensions.
+   */
+  template <typename Scalar>
+  static void accumulate(Scalar *destination,
+                         const Scalar *source,
+                         Index n_outer,
+                         const SpectralIndexMap &map_inc,
+                         const SpectralIndexMap &map_scat,
+                         Index n_inner) {
+    Index n_inner_destination = map_scat.n_destination_coeffs_ * n_inner;
+    Index n_inner_source = map_scat.n_source_coeffs_ * n_inner;
+    for (Index i = 0; i < n_outer; ++i) {
+      Scalar *dst =
+          destination + i * map_inc.n_destination_coeffs_ * n_inner_destination;
+      const Scalar *src = source + i * map_inc.n_source_coeffs_ * n_inner_source;
+      for (auto &b : map_inc.blocks_) {
+        map_scat.accumulate(dst + b.destination_start * n_inner_destination,
+                            src + b.source_start * n_inner_source,
+                            b.size,
+                            n_inner);
+      }
+    }
+  }
+
+  /** Copy coefficients.
+   *
+   * Like accumulate(...) but overwrites the destination, setting
+   * coefficients that are not present in the source expansion to zero.
+   * Each destination coefficient is written exactly once, so the
+   * destination does not need to be initialized.
+   *
+   * @param destination Pointer to the destination data.
+   * @param source Pointer to the source data.
+   * @param n_outer The product of the dimensions before the coefficient
+   * dimension.
+   * @param n_inner The product of the dimensions after the coefficient
+   * dimension.
+   */
+  template <typename Scalar>
+  void copy(Scalar *destination,
+            const Scalar *source,
+            Index n_outer,
+            Index n_inner) const {
+    for (Index i = 0; i < n_outer; ++i) {
+      Scalar *dst = destination + i * n_destination_coeffs_ * n_inner;
+      const Scalar *src = source + i * n_source_coeffs_ * n_inner;
+      Index position = 0;
+      for (auto &b : blocks_) {
+        std::fill(dst + position * n_inner,
+                  dst + b.destination_start * n_inner,
+                  Scalar(0.0));
+        std::copy(src + b.source_start * n_inner,
+                  src + (b.source_start + b.size) * n_inner,
+                  dst + b.destination_start * n_inner);
+        position = b.destination_start + b.size;
+      }
+      std::fill(dst + position * n_inner,
+                dst + n_destination_coeffs_ * n_inner,
+                Scalar(0.0));
+    }
+  }
+
+  /** Copy coefficients of a two-dimensional expansion.
+   *
+   * Like the two-dimensional accumulate(...) but overwrites the
+   * destination, setting coefficients that are not present in the source
+   * expansion to zero.
+   *
+   * @param destination Pointer to the destination data.
+   * @param source Pointer to the source data.
+   * @param n_outer The product of the dimensions before the coefficient
+   * dimensions.
+   * @param map_inc Index map for the first coefficient dimension.
+   * @param map_scat Index map for the second coefficient dimension.
+   * @param n_inner The product of the dimensions after the coefficient
+   * dimensions.
+   */
+  template <typename Scalar>
+  static void copy(Scalar *destination,
+                   const Scalar *source,
+                   Index n_outer,
+                   const SpectralIndexMap &map_inc,
+                   const SpectralIndexMap &map_scat,
+                   Index n_inner) {
+    Index n_inner_destination = map_scat.n_destination_coeffs_ * n_inner;
+    Index n_inner_source = map_scat.n_source_coeffs_ * n_inner;
+    for (Index i = 0; i < n_outer; ++i) {
+      Scalar *dst =
+          destination + i * map_inc.n_destination_coeffs_ * n_inner_destination;
+      const Scalar *src = source + i * map_inc.n_source_coeffs_ * n_inner_source;
+      Index position = 0;
+      for (auto &b : map_inc.blocks_) {
+        std::fill(dst + position * n_inner_destination,
+                  dst + b.destination_start * n_inner_destination,
+                  Scalar(0.0));
+        map_scat.copy(dst + b.destination_start * n_inner_destination,
+                      src + b.source_start * n_inner_source,
+                      b.size,
+                      n_inner);
+        position = b.destination_start + b.size;
+      }
+      std::fill(dst + position * n_inner_destination,
+                dst + map_inc.n_destination_coeffs_ * n_inner_destination,
+                Scalar(0.0));
+    }
+  }
+
+ private:
+  template <typename Scalar>
+  static void add(Scalar *destination, const Scalar *source, Index n) {
+    for (Index i = 0; i < n; ++i) {
+      destination[i] += source[i];
+    }
+  }
+
+  static std::mutex mutex_;
+  static std::map<std::array<Index, 9>,
+                  std::shared_ptr<const SpectralIndexMap>>
+      cache_;
+
+  Index n_source_coeffs_, n_destination_coeffs_;
+  std::vector<Block> blocks_;
 };
 
-/** SHT instance provider.
+////////////////////////////////////////////////////////////////////////////////
+// SHTProvider
+////////////////////////////////////////////////////////////////////////////////
+/** Process-wide registry of SHT instances.
  *
- * Simple cache that caches created SHT instances.
+ * SHT objects for identical parameters are interchangeable, so conversions
+ * between data formats obtain them from this registry instead of creating
+ * new ones. The registry hands out shared, read-only handles: All
+ * transforms that are required by the conversion paths are available as
+ * const methods that take a workspace, so the same instance can be used
+ * from several threads concurrently.
+ *
+ * Lookups are synchronized. The memory held by the registry is bounded by
+ * a configurable budget. When it is exceeded, the least recently used
+ * instances are evicted. Evicted instances remain valid until the last
+ * handle referencing them is released.
  */
 class SHTProvider {
  public:
+  /// SHT parameters: l_max, m_max, n_lon, n_lat.
   using SHTParams = std::array<Index, 4>;
+  using ShtPtr = std::shared_ptr<const SHT>;
 
-  SHTProvider();
+  /** Get SHT instance for given SHT parameters.
+   * @param l_max The maximum degree of the SHT.
+   * @param m_max The maximum order of the SHT.
+   * @param n_lon The number of longitude grid points.
+   * @param n_lat The number of co-latitude grid points.
+   * @return Shared handle to the SHT instance.
+   */
+  static ShtPtr get(Index l_max, Index m_max, Index n_lon, Index n_lat);
 
   /** Get SHT instance for given SHT parameters.
-   * @arg params Lenght-4 array containing the parameters required to initialize
-   * the SHT transform: l_max, m_max, n_lat, n_lon. See documention of SHT class
-   * for explanation of their significance.
-   * @return Reference to SHT instance.
+   * @param params Length-4 array containing the parameters required to
+   * initialize the SHT transform: l_max, m_max, n_lon, n_lat. See
+   * documentation of SHT class for explanation of their significance.
+   * @return Shared handle to the SHT instance.
+   */
+  static ShtPtr get(SHTParams params);
+
+  /** Get SHT instance with the same parameters as a given SHT.
+   * @param sht The SHT whose parameters to use.
+   * @return Shared handle to the SHT instance.
    */
-  SHT &get_sht_instance(SHTParams params);
+  static ShtPtr get(const SHT &sht);
+
+  /** Set memory budget of the registry.
+   *
+   * If the registry currently holds more memory than the new budget,
+   * the least recently used instances are evicted.
+   *
+   * @param n_bytes The maximum number of bytes held by cached instances.
+   */
+  static void set_memory_budget(size_t n_bytes);
+  /// The maximum number of bytes held by cached instances.
+  static size_t get_memory_budget();
+  /// The number of bytes currently held by cached instances.
+  static size_t get_memory_usage();
+  /// The number of currently cached instances.
+  static size_t get_size();
+
+  /// Remove all instances from the registry.
+  static void clear();
+
+ private:
+  static size_t calculate_memory_usage(const SHTParams &params);
+  static void evict(size_t n_bytes);
+
+  using LruList = std::list<SHTParams>;
+  struct Entry {
+    ShtPtr sht;
+    size_t n_bytes;
+    LruList::iterator position;
+  };
 
- protected:
-  std::map<SHTParams, std::unique_ptr<SHT>> sht_instances_;
+  static std::mutex mutex_;
+  static size_t memory_budget_, memory_usage_;
+  static LruList lru_;
+  static std::map<SHTParams, Entry> entries_;
 };
 
 }  // namespace sht
@@ -180,7 +180,7 @@ class SingleScatteringData {
       scattering::eigen::VectorPtr<double> t_grid,
       scattering::eigen::VectorPtr<double> lon_inc,
       scattering::eigen::VectorPtr<double> lat_inc,
-      std::shared_ptr<sht::SHT> sht_scat,
+      std::shared_ptr<const sht::SHT> sht_scat,
       scattering::eigen::TensorPtr<std::complex<double>, 6> phase_matrix,
       scattering::eigen::TensorPtr<std::complex<double>, 6> extinction_matrix,
       scattering::eigen::TensorPtr<std::complex<double>, 6> absorption_vector,
@@ -152,6 +152,13 @@ sht::SHT ScatteringData::get_sht() {
   return sht::SHT(l_max, l_max, 2 * l_max + 2, 2 * l_max + 2);
 }
 
+std::shared_ptr<const sht::SHT> ScatteringData::get_sht_ptr() {
+  auto phase_matrix_dimensions =
+      group_.get_variable("phaMat_data_real").shape();
+  auto l_max = sht::SHT::calc_l_max(phase_matrix_dimensions[3]);
+  return sht::SHTProvider::get(l_max, l_max, 2 * l_max + 2, 2 * l_max + 2);
+}
+
 eigen::Vector<double> ScatteringData::get_lon_inc() {
   if (format_ == DataFormat::Gridded) {
     return get_vector<double>("aa_inc");
@@ -271,25 +278,21 @@ ScatteringData::get_backward_scattering_coeff_data_gridded() {
 
 eigen::Tensor<std::complex<double>, 6>
 ScatteringData::get_backward_scattering_coeff_data_spectral() {
-  auto phase_matrix = get_phase_matrix_data_spectral();
-  auto sht = get_sht();
+  auto sht = get_sht_ptr();
   auto data_spectral =
       ScatteringDataFieldSpectral(get_f_grid(),
                                   get_t_grid(),
                                   get_lon_inc(),
                                   get_lat_inc(),
-                                  sht,
+                                  *sht,
                                   get_phase_matrix_data_spectral());
-  auto data_gridded = data_spectral.to_gridded();
-  auto phase_matrix_gridded = data_gridded.get_data();
-  auto dimensions = phase_matrix_gridded.dimensions();
-  auto backward_scattering_coeff =
-      phase_matrix_gridded.chip<4>(0).chip<4>(dimensions[5] - 1).chip<4>(0);
-  auto dimensions_output = phase_matrix.dimensions();
-  dimensions_output[4] = 1;
-  dimensions_output[5] = 1;
+  eigen::Tensor<double, 4> backward_scattering_coeff =
+      data_spectral.evaluate_backward().chip<4>(0);
+  auto dimensions = data_spectral.get_data().dimensions();
+  dimensions[4] = 1;
+  dimensions[5] = 1;
   return backward_scattering_coeff.cast<std::complex<double>>().reshape(
-      dimensions_output);
+      dimensions);
 }
 
 eigen::Tensor<double, 7>
@@ -305,25 +308,21 @@ ScatteringData::get_forward_scattering_coeff_data_gridded() {
 }
 eigen::Tensor<std::complex<double>, 6>
 ScatteringData::get_forward_scattering_coeff_data_spectral() {
-  auto phase_matrix = get_phase_matrix_data_spectral();
-  auto sht = get_sht();
-
+  auto sht = get_sht_ptr();
   auto data_spectral =
       ScatteringDataFieldSpectral(get_f_grid(),
                                   get_t_grid(),
                                   get_lon_inc(),
                                   get_lat_inc(),
-                                  sht,
+                                  *sht,
                                   get_phase_matrix_data_spectral());
-  auto data_gridded = data_spectral.to_gridded();
-  auto phase_matrix_gridded = data_gridded.get_data();
-  auto forward_scattering_coeff =
-      phase_matrix_gridded.chip<4>(0).chip<4>(0).chip<4>(0);
-  auto dimensions_output = phase_matrix.dimensions();
-  dimensions_output[4] = 1;
-  dimensions_output[5] = 1;
+  eigen::Tensor<double, 4> forward_scattering_coeff =
+      data_spectral.evaluate_forward().chip<4>(0);
+  auto dimensions = data_spectral.get_data().dimensions();
+  dimensions[4] = 1;
+  dimensions[5] = 1;
   return forward_scattering_coeff.cast<std::complex<double>>().reshape(
-      dimensions_output);
+      dimensions);
 }
 
 ScatteringData::operator SingleScatteringDataGridded<double>() {
@@ -344,7 +343,7 @@ ScatteringData::operator SingleScatteringDataGridded<double>() {
   auto backward_scattering_coeff = std::make_shared<eigen::Tensor<double, 7>>(
       get_backward_scattering_coeff_data_gridded());
   auto forward_scattering_coeff = std::make_shared<eigen::Tensor<double, 7>>(
-      get_backward_scattering_coeff_data_gridded());
+      get_forward_scattering_coeff_data_gridded());
   return SingleScatteringDataGridded<double>(f_grid,
                                              t_grid,
                                              lon_inc,
@@ -365,7 +364,7 @@ ScatteringData::operator SingleScatteringDataSpectral<double>() {
   auto t_grid = std::make_shared<eigen::Vector<double>>(get_t_grid());
   auto lon_inc = std::make_shared<eigen::Vector<double>>(get_lon_inc());
   auto lat_inc = std::make_shared<eigen::Vector<double>>(get_lat_inc());
-  auto sht = std::make_shared<sht::SHT>(get_sht());
+  auto sht = get_sht_ptr();
   auto phase_matrix = std::make_shared<eigen::Tensor<std::complex<double>, 6>>(
       get_phase_matrix_data_spectral());
   auto extinction_matrix =
@@ -379,7 +378,7 @@ ScatteringData::operator SingleScatteringDataSpectral<double>() {
           get_backward_scattering_coeff_data_spectral());
   auto forward_scattering_coeff =
       std::make_shared<eigen::Tensor<std::complex<double>, 6>>(
-          get_backward_scattering_coeff_data_spectral());
+          get_forward_scattering_coeff_data_spectral());
   return SingleScatteringDataSpectral<double>(f_grid,
                                               t_grid,
                                               lon_inc,
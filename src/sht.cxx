@@ -1,5 +1,13 @@
 #include <scattering/sht.h>
 
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 namespace scattering {
 namespace sht {
 
@@ -23,23 +31,202 @@ FFTWArray<Numeric>::FFTWArray(Index n) : ptr_(nullptr) {
   }
 }
 
-shtns_cfg ShtnsHandle::get(Index l_max,
-                           Index m_max,
-                           Index n_lon,
-                           Index n_lat) {
-  std::array<Index, 4> config = {l_max, m_max, n_lon, n_lat};
-  if (config == current_config_) {
-    return shtns_;
-  } else {
-    shtns_reset();
-    shtns_ = shtns_init(sht_reg_fast, l_max, m_max, 1, n_lat, n_lon);
-    current_config_ = config;
+////////////////////////////////////////////////////////////////////////////////
+// SHTns configurations
+////////////////////////////////////////////////////////////////////////////////
+
+// shtns_destroy modifies global SHTns and FFTW state, so configurations
+// are destroyed while holding the cache mutex. The mutex is recursive
+// because the last handle may be released during eviction.
+ShtnsConfig::ShtnsConfig(shtns_cfg cfg)
+    : cfg_(cfg, [](shtns_cfg c) {
+        if (c) {
+          std::lock_guard<std::recursive_mutex> lock(ShtnsHandle::mutex_);
+          shtns_destroy(c);
+        }
+      }) {}
+
+ShtnsConfig ShtnsHandle::get(Index l_max,
+                             Index m_max,
+                             Index n_lon,
+                             Index n_lat,
+                             Index n_threads) {
+  Config config = {l_max, m_max, n_lon, n_lat, n_threads};
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+
+  auto found = entries_.find(config);
+  if (found != entries_.end()) {
+    ++hits_;
+    lru_.splice(lru_.begin(), lru_, found->second.position);
+    return found->second.cfg;
+  }
+
+  ++misses_;
+  // Make room for new entry before SHTns allocates the new tables.
+  evict((capacity_ > 0) ? capacity_ - 1 : 0);
+  shtns_use_threads(n_threads);
+  ShtnsConfig cfg{shtns_init(sht_reg_fast, l_max, m_max, 1, n_lat, n_lon)};
+  if (capacity_ > 0) {
+    lru_.push_front(config);
+    entries_[config] = Entry{cfg, lru_.begin()};
+  }
+  return cfg;
+}
+
+void ShtnsHandle::evict(size_t capacity) {
+  while (lru_.size() > capacity) {
+    entries_.erase(lru_.back());
+    lru_.pop_back();
+    ++evictions_;
   }
-  return shtns_;
 }
 
-shtns_cfg ShtnsHandle::shtns_ = nullptr;
-std::array<Index, 4> ShtnsHandle::current_config_ = {-1, -1, -1, -1};
+void ShtnsHandle::set_capacity(size_t capacity) {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  capacity_ = capacity;
+  evict(capacity_);
+}
+
+size_t ShtnsHandle::get_capacity() {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  return capacity_;
+}
+
+size_t ShtnsHandle::get_size() {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  return lru_.size();
+}
+
+size_t ShtnsHandle::get_hits() {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  return hits_;
+}
+
+size_t ShtnsHandle::get_misses() {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  return misses_;
+}
+
+size_t ShtnsHandle::get_evictions() {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  return evictions_;
+}
+
+void ShtnsHandle::reset_statistics() {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  hits_ = 0;
+  misses_ = 0;
+  evictions_ = 0;
+}
+
+void ShtnsHandle::clear() {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  evict(0);
+}
+
+std::recursive_mutex ShtnsHandle::mutex_;
+size_t ShtnsHandle::capacity_ = 16;
+size_t ShtnsHandle::hits_ = 0;
+size_t ShtnsHandle::misses_ = 0;
+size_t ShtnsHandle::evictions_ = 0;
+ShtnsHandle::LruList ShtnsHandle::lru_;
+std::map<ShtnsHandle::Config, ShtnsHandle::Entry> ShtnsHandle::entries_;
+
+////////////////////////////////////////////////////////////////////////////////
+// LegendreExpansion
+////////////////////////////////////////////////////////////////////////////////
+
+LegendreExpansion::LegendreExpansion(Index l_max,
+                                     const eigen::Vector<double> &cos_thetas)
+    : l_max_(l_max), table_(cos_thetas.size(), l_max + 1) {
+  if (l_max_ == 0) {
+    table_.setConstant(1.0);
+    return;
+  }
+  auto shtns = ShtnsHandle::get(l_max_, 0, 1, 2 * l_max_ + 2);
+  for (Index i = 0; i < cos_thetas.size(); ++i) {
+    legendre_sphPlm_array(shtns, l_max_, 0, cos_thetas[i], table_.row(i).data());
+  }
+}
+
+std::shared_ptr<const LegendreExpansion> LegendreExpansion::get(
+    Index l_max,
+    const eigen::Vector<double> &cos_thetas) {
+  auto key = std::make_pair(
+      l_max,
+      std::vector<double>(cos_thetas.data(),
+                          cos_thetas.data() + cos_thetas.size()));
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto found = cache_.find(key);
+    if (found != cache_.end()) {
+      return found->second;
+    }
+  }
+  auto table = std::make_shared<const LegendreExpansion>(l_max, cos_thetas);
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (cache_.size() >= cache_size_) {
+    cache_.clear();
+  }
+  cache_[key] = table;
+  return table;
+}
+
+eigen::Vector<double> LegendreExpansion::evaluate(
+    const SpectralCoeffsRef &coeffs) const {
+  assert(coeffs.size() == l_max_ + 1);
+  return eigen::Vector<double>(coeffs.real()) * table_.transpose();
+}
+
+void LegendreExpansion::evaluate(
+    eigen::TensorMap<double, 3> output,
+    eigen::ConstTensorMap<std::complex<double>, 2> coeffs) const {
+  Index n_lon = output.dimension(0);
+  Index n_points = output.dimension(1);
+  Index n_fields = output.dimension(2);
+  assert(n_points == table_.rows());
+  assert(coeffs.dimension(0) == l_max_ + 1);
+  assert(coeffs.dimension(1) == n_fields);
+
+  eigen::ConstMatrixMap<std::complex<double>> c(coeffs.data(),
+                                                l_max_ + 1,
+                                                n_fields);
+  eigen::MatrixMap<double> values(output.data(), n_points, n_fields);
+  values.noalias() = table_ * eigen::Matrix<double>(c.real());
+  for (Index i = 1; i < n_lon; ++i) {
+    std::copy_n(output.data(),
+                n_points * n_fields,
+                output.data() + i * n_points * n_fields);
+  }
+}
+
+void LegendreExpansion::evaluate(
+    eigen::TensorMap<float, 3> output,
+    eigen::ConstTensorMap<std::complex<float>, 2> coeffs) const {
+  Index n_lon = output.dimension(0);
+  Index n_points = output.dimension(1);
+  Index n_fields = output.dimension(2);
+  assert(n_points == table_.rows());
+  assert(coeffs.dimension(0) == l_max_ + 1);
+  assert(coeffs.dimension(1) == n_fields);
+
+  eigen::ConstMatrixMap<std::complex<float>> c(coeffs.data(),
+                                               l_max_ + 1,
+                                               n_fields);
+  eigen::MatrixMap<float> values(output.data(), n_points, n_fields);
+  values = (table_ * eigen::Matrix<double>(c.real().cast<double>()))
+               .cast<float>();
+  for (Index i = 1; i < n_lon; ++i) {
+    std::copy_n(output.data(),
+                n_points * n_fields,
+                output.data() + i * n_points * n_fields);
+  }
+}
+
+std::mutex LegendreExpansion::mutex_;
+std::map<std::pair<Index, std::vector<double>>,
+         std::shared_ptr<const LegendreExpansion>>
+    LegendreExpansion::cache_;
 
 ////////////////////////////////////////////////////////////////////////////////
 // SHT
@@ -50,23 +237,9 @@ SpectralCoeffs SHT::add_coeffs(const SHT &sht_l,
                                const SHT &sht_r,
                                SpectralCoeffsRef w) {
   auto result = SpectralCoeffs(v);
-
-  if (sht_r.is_trivial_) {
-    result[0] += w[0];
-    return result;
-  }
-
-  Index m_max_min = std::min(sht_l.m_max_, sht_r.m_max_);
-  Index l_max_min = std::min(sht_l.l_max_, sht_r.l_max_);
-  for (Index m = 0; m <= m_max_min; ++m) {
-    Index index_r = m * (sht_r.l_max_ + 1) - (m * (m - 1)) / 2;
-    Index index_l = m * (sht_l.l_max_ + 1) - (m * (m - 1)) / 2;
-    for (Index l = m; l <= l_max_min; ++l) {
-      result[index_l] += w[index_r];
-      ++index_r;
-      ++index_l;
-    }
-  }
+  auto index_map = SpectralIndexMap::get(sht_r, sht_l);
+  SpectralCoeffs w_contiguous = w;
+  index_map->accumulate(result.data(), w_contiguous.data(), 1, 1);
   return result;
 }
 
@@ -76,27 +249,12 @@ SpectralCoeffMatrix SHT::add_coeffs(const SHT &sht_inc_l,
                                     const SHT &sht_inc_r,
                                     const SHT &sht_scat_r,
                                     SpectralCoeffMatrixRef w) {
-  Index nlm_inc = sht_inc_l.get_n_spectral_coeffs_cmplx();
-  Index nlm_scat = sht_scat_l.get_n_spectral_coeffs();
-  auto result = SpectralCoeffMatrix(nlm_inc, nlm_scat);
-
-  Index index_l = 0;
-  for (int l = 0; l <= (int)sht_inc_l.l_max_; ++l) {
-    int m_max = (l <= (int)sht_inc_l.m_max_) ? l : sht_inc_l.m_max_;
-    for (int m = -m_max; m <= m_max; ++m) {
-      if ((l > sht_inc_r.l_max_) || (std::abs(m) > sht_inc_r.m_max_)) {
-        result.row(index_l) = v.row(index_l);
-      } else {
-        int h = std::min<int>(sht_inc_r.m_max_, l);
-        int index_r = l * (2 * h + 1) - h * h + m;
-
-        auto r =
-            add_coeffs(sht_scat_l, v.row(index_l), sht_scat_r, w.row(index_r));
-        result.row(index_l) = r;
-      }
-      ++index_l;
-    }
-  }
+  auto result = SpectralCoeffMatrix(v);
+  auto map_inc = SpectralIndexMap::get(sht_inc_r, sht_inc_l, true);
+  auto map_scat = SpectralIndexMap::get(sht_scat_r, sht_scat_l);
+  SpectralCoeffMatrix w_contiguous = w;
+  SpectralIndexMap::accumulate(
+      result.data(), w_contiguous.data(), 1, *map_inc, *map_scat, 1);
   return result;
 }
 
@@ -126,6 +284,28 @@ std::array<Index, 4> SHT::get_params(Index n_lon, Index n_lat) {
   return {l_max, m_max, n_lon, n_lat};
 }
 
+void SHT::set_n_threads(Index n_threads) {
+#ifdef _OPENMP
+  if (n_threads < 1) {
+    n_threads = omp_get_max_threads();
+  }
+  n_threads_ = n_threads;
+#else
+  (void) n_threads;
+#endif
+}
+
+Index SHT::get_n_threads() { return n_threads_; }
+
+void SHT::set_intra_threading_l_max(Index l_max) {
+  intra_threading_l_max_ = l_max;
+}
+
+Index SHT::get_intra_threading_l_max() { return intra_threading_l_max_; }
+
+Index SHT::n_threads_ = 1;
+Index SHT::intra_threading_l_max_ = 128;
+
 SHT::SHT(Index l_max, Index m_max, Index n_lon, Index n_lat)
     : l_max_(l_max), m_max_(m_max), n_lon_(n_lon), n_lat_(n_lat) {
   if (l_max == 0) {
@@ -135,14 +315,9 @@ SHT::SHT(Index l_max, Index m_max, Index n_lon, Index n_lat)
   } else {
     is_trivial_ = false;
     shtns_verbose(1);
-    shtns_use_threads(0);
     n_spectral_coeffs_ = calc_n_spectral_coeffs(l_max, m_max);
     n_spectral_coeffs_cmplx_ = calc_n_spectral_coeffs_cmplx(l_max, m_max);
-    spectral_coeffs_ = sht::FFTWArray<std::complex<double>>(n_spectral_coeffs_);
-    spectral_coeffs_cmplx_ =
-        sht::FFTWArray<std::complex<double>>(n_spectral_coeffs_cmplx_);
-    spatial_coeffs_ = sht::FFTWArray<double>(n_lon * n_lat);
-    cmplx_spatial_coeffs_ = sht::FFTWArray<std::complex<double>>(n_lon * n_lat);
+    workspace_ = create_workspace();
   }
 }
 
@@ -155,22 +330,22 @@ SHT::SHT(Index l_max, Index m_max)
 SHT::SHT(Index l_max)
     : SHT(l_max, l_max) {}
 
-  SHT::LatGrid SHT::get_latitude_grid() {
+  SHT::LatGrid SHT::get_latitude_grid() const {
   if (is_trivial_) {
     return SHT::LatGrid(1);
   }
   return SHT::LatGrid(n_lat_);
 }
 
-SHT::Vector SHT::get_colatitude_grid() {
+SHT::Vector SHT::get_colatitude_grid() const {
   if (is_trivial_) {
     return Vector::Constant(1, M_PI / 2.0);
   }
-  auto shtns = ShtnsHandle::get(l_max_, m_max_, n_lon_, n_lat_);
+  auto shtns = get_shtns();
   return ConstVectorMap(shtns->ct, n_lat_);
 }
 
-SHT::Vector SHT::get_longitude_grid() {
+SHT::Vector SHT::get_longitude_grid() const {
   if (is_trivial_) {
     return Vector::Constant(1, M_PI);
   }
@@ -182,11 +357,11 @@ SHT::Vector SHT::get_longitude_grid() {
   return v;
 }
 
-SHT::IndexVector SHT::get_l_indices() {
+SHT::IndexVector SHT::get_l_indices() const {
   if (is_trivial_) {
     return IndexVector::Constant(1, 0);
   }
-  auto shtns = ShtnsHandle::get(l_max_, m_max_, n_lon_, n_lat_);
+  auto shtns = get_shtns();
   IndexVector result(n_spectral_coeffs_);
   for (Index i = 0; i < n_spectral_coeffs_; ++i) {
     result[i] = shtns->li[i];
@@ -194,11 +369,11 @@ SHT::IndexVector SHT::get_l_indices() {
   return result;
 }
 
-SHT::IndexVector SHT::get_m_indices() {
+SHT::IndexVector SHT::get_m_indices() const {
   if (is_trivial_) {
     return IndexVector::Constant(1, 0);
   }
-  auto shtns = ShtnsHandle::get(l_max_, m_max_, n_lon_, n_lat_);
+  auto shtns = get_shtns();
   IndexVector result(n_spectral_coeffs_);
   for (Index i = 0; i < n_spectral_coeffs_; ++i) {
     result[i] = shtns->mi[i];
@@ -206,182 +381,1049 @@ SHT::IndexVector SHT::get_m_indices() {
   return result;
 }
 
-void SHT::set_spatial_coeffs(const GridCoeffsRef &m) const {
+SHT::Vector SHT::get_pole_weights(bool south) const {
+  if (is_trivial_) {
+    return Vector::Constant(1, 1.0);
+  }
+  // Orthonormal m = 0 basis functions: sqrt((2l + 1) / 4 pi) * P_l(+/-1).
+  Vector result(l_max_ + 1);
+  for (Index l = 0; l <= l_max_; ++l) {
+    double sign = (south && (l % 2)) ? -1.0 : 1.0;
+    result[l] = sign * sqrt((2.0 * l + 1.0) / (4.0 * M_PI));
+  }
+  return result;
+}
+
+Index SHT::get_n_threads_intra(Index n_fields) const {
+#ifdef _OPENMP
+  if (omp_in_parallel()) {
+    return 1;
+  }
+#endif
+  if ((l_max_ >= intra_threading_l_max_) || (n_fields < n_threads_)) {
+    return n_threads_;
+  }
+  return 1;
+}
+
+Index SHT::get_n_threads_across(Index n_fields) const {
+  if (get_n_threads_intra(n_fields) > 1) {
+    return 1;
+  }
+#ifdef _OPENMP
+  if (omp_in_parallel()) {
+    return 1;
+  }
+#endif
+  return std::max<Index>(std::min(n_threads_, n_fields), 1);
+}
+
+ShtnsConfig SHT::get_shtns(Index n_fields) const {
+  return ShtnsHandle::get(
+      l_max_, m_max_, n_lon_, n_lat_, get_n_threads_intra(n_fields));
+}
+
+SHTWorkspace SHT::create_workspace() const {
+  if (is_trivial_) {
+    return SHTWorkspace();
+  }
+  return SHTWorkspace(n_spectral_coeffs_,
+                      n_spectral_coeffs_cmplx_,
+                      n_lon_ * n_lat_);
+}
+
+namespace detail {
+
+/** Alignment required for arrays passed directly to SHTns.
+ *
+ * The FFTW plans used by SHTns are created for arrays allocated using
+ * fftw_malloc. Arrays not allocated by us are only passed to SHTns if
+ * they satisfy the strictest SIMD alignment requirement.
+ */
+constexpr std::uintptr_t shtns_alignment = 64;
+
+/// Check if array can be passed directly to SHTns.
+template <typename Numeric>
+bool is_aligned(const Numeric *ptr) {
+  return reinterpret_cast<std::uintptr_t>(ptr) % shtns_alignment == 0;
+}
+
+/// Check whether matrix is stored as contiguous, longitude-major array.
+template <typename Matrix>
+bool is_contiguous(const Matrix &m) {
+  return (m.innerStride() == 1) && (m.outerStride() == m.cols());
+}
+
+/** Copy spatial field into contiguous, longitude-major array.
+ * @param dst Pointer to the destination array.
+ * @param m The spatial field.
+ */
+template <typename Matrix, typename Numeric>
+void copy_spatial_coeffs(Numeric *dst, const Matrix &m) {
+  if (is_contiguous(m)) {
+    std::copy_n(m.data(), m.size(), dst);
+    return;
+  }
   Index index = 0;
-  // Rows and columns of input must match n_lon and n_lat of SHT.
-  assert(m.rows() == n_lon_);
-  assert(m.cols() == n_lat_);
   for (int i = 0; i < m.rows(); ++i) {
     for (int j = 0; j < m.cols(); ++j) {
-      spatial_coeffs_[index] = m(i, j);
+      dst[index] = m(i, j);
       ++index;
     }
   }
 }
 
-void SHT::set_spatial_coeffs(const CmplxGridCoeffsRef &m) const {
+/** Copy contiguous, longitude-major array into spatial field.
+ * @param m The matrix to copy the data to.
+ * @param src Pointer to the source array.
+ */
+template <typename Matrix, typename Numeric>
+void copy_spatial_coeffs(Matrix &&m, const Numeric *src) {
+  if (is_contiguous(m)) {
+    std::copy_n(src, m.size(), m.data());
+    return;
+  }
   Index index = 0;
-  // Rows and columns of input must match n_lon and n_lat of SHT.
-  assert(m.rows() == n_lon_);
-  assert(m.cols() == n_lat_);
   for (int i = 0; i < m.rows(); ++i) {
     for (int j = 0; j < m.cols(); ++j) {
-      cmplx_spatial_coeffs_[index] = m(i, j);
+      m(i, j) = src[index];
       ++index;
     }
   }
 }
 
+/** Copy spectral coefficients into contiguous array.
+ * @param dst Pointer to the destination array.
+ * @param m The spectral coefficient vector.
+ */
+template <typename Vector>
+void copy_spectral_coeffs(std::complex<double> *dst, const Vector &m) {
+  if (m.innerStride() == 1) {
+    std::copy_n(m.data(), m.size(), dst);
+    return;
+  }
+  for (Index i = 0; i < m.size(); ++i) {
+    dst[i] = m[i];
+  }
+}
+
+/** Copy contiguous array into spectral coefficient vector.
+ * @param m The vector to copy the coefficients to.
+ * @param src Pointer to the source array.
+ */
+template <typename Vector>
+void copy_spectral_coeffs(Vector &&m, const std::complex<double> *src) {
+  if (m.innerStride() == 1) {
+    std::copy_n(src, m.size(), m.data());
+    return;
+  }
+  for (Index i = 0; i < m.size(); ++i) {
+    m[i] = src[i];
+  }
+}
+
+}  // namespace detail
+
+void SHT::set_spatial_coeffs(const GridCoeffsRef &m) const {
+  // Rows and columns of input must match n_lon and n_lat of SHT.
+  assert(m.rows() == n_lon_);
+  assert(m.cols() == n_lat_);
+  detail::copy_spatial_coeffs(workspace_.spatial_coeffs.get(), m);
+}
+
+void SHT::set_spatial_coeffs(const CmplxGridCoeffsRef &m) const {
+  // Rows and columns of input must match n_lon and n_lat of SHT.
+  assert(m.rows() == n_lon_);
+  assert(m.cols() == n_lat_);
+  detail::copy_spatial_coeffs(workspace_.cmplx_spatial_coeffs.get(), m);
+}
+
 void SHT::set_spectral_coeffs(const SpectralCoeffsRef &m) const {
   // Input size must match number of spectral coefficients of SHT.
   assert(m.size() == n_spectral_coeffs_);
-  Index index = 0;
-  for (auto &x : m) {
-    spectral_coeffs_[index] = x;
-    ++index;
-  }
+  detail::copy_spectral_coeffs(workspace_.spectral_coeffs.get(), m);
 }
 
 void SHT::set_spectral_coeffs_cmplx(const SpectralCoeffsRef &m) const {
   // Input size must match number of spectral coefficients of SHT.
   assert(m.size() == n_spectral_coeffs_cmplx_);
-  Index index = 0;
-  for (auto &x : m) {
-    spectral_coeffs_cmplx_[index] = x;
-    ++index;
-  }
+  detail::copy_spectral_coeffs(workspace_.spectral_coeffs_cmplx.get(), m);
 }
 
 GridCoeffs SHT::get_spatial_coeffs() const {
   GridCoeffs result(n_lon_, n_lat_);
-  Index index = 0;
-  for (int i = 0; i < result.rows(); ++i) {
-    for (int j = 0; j < result.cols(); ++j) {
-      result(i, j) = spatial_coeffs_[index];
-      ++index;
-    }
-  }
+  detail::copy_spatial_coeffs(result, workspace_.spatial_coeffs.get());
   return result;
 }
 
 CmplxGridCoeffs SHT::get_cmplx_spatial_coeffs() const {
   CmplxGridCoeffs result(n_lon_, n_lat_);
-  Index index = 0;
-  for (int i = 0; i < result.rows(); ++i) {
-    for (int j = 0; j < result.cols(); ++j) {
-      result(i, j) = cmplx_spatial_coeffs_[index];
-      ++index;
-    }
-  }
+  detail::copy_spatial_coeffs(result, workspace_.cmplx_spatial_coeffs.get());
   return result;
 }
 
 SpectralCoeffs SHT::get_spectral_coeffs() const {
   SpectralCoeffs result(n_spectral_coeffs_);
-  Index index = 0;
-  for (auto &x : result) {
-    x = spectral_coeffs_[index];
-    ++index;
-  }
+  detail::copy_spectral_coeffs(result, workspace_.spectral_coeffs.get());
   return result;
 }
 
 SpectralCoeffs SHT::get_spectral_coeffs_cmplx() const {
   SpectralCoeffs result(n_spectral_coeffs_cmplx_);
-  Index index = 0;
-  for (auto &x : result) {
-    x = spectral_coeffs_cmplx_[index];
-    ++index;
-  }
+  detail::copy_spectral_coeffs(result, workspace_.spectral_coeffs_cmplx.get());
   return result;
 }
 
 SpectralCoeffs SHT::transform(const GridCoeffsRef &m) {
+  return transform(m, workspace_);
+}
+
+SpectralCoeffs SHT::transform_cmplx(const CmplxGridCoeffsRef &m) {
+  return transform_cmplx(m, workspace_);
+}
+
+GridCoeffs SHT::synthesize(const SpectralCoeffsRef &m) {
+  return synthesize(m, workspace_);
+}
+
+CmplxGridCoeffs SHT::synthesize_cmplx(const SpectralCoeffsRef &m) {
+  return synthesize_cmplx(m, workspace_);
+}
+
+template <typename OutputVector, typename InputMatrix>
+bool SHT::transform_real_cmplx(OutputVector &&output,
+                               const InputMatrix &m,
+                               SHTWorkspace &workspace) const {
+  double *spatial = workspace.spatial_coeffs;
+  Index index = 0;
+  for (Index i = 0; i < m.rows(); ++i) {
+    for (Index j = 0; j < m.cols(); ++j) {
+      if (m(i, j).imag() != 0.0) {
+        return false;
+      }
+      spatial[index] = m(i, j).real();
+      ++index;
+    }
+  }
+  auto shtns = get_shtns();
+  spat_to_SH(shtns, workspace.spatial_coeffs, workspace.spectral_coeffs);
+
+  // The coefficients of a real field satisfy c(l, -m) = (-1)^m conj(c(l, m)),
+  // so the complex expansion follows from the coefficients with m >= 0.
+  const std::complex<double> *coeffs = workspace.spectral_coeffs;
+  Index index_real = 0;
+  for (Index im = 0; im <= m_max_; ++im) {
+    double sign = (im % 2 == 0) ? 1.0 : -1.0;
+    for (Index il = im; il <= l_max_; ++il) {
+      Index h = std::min(m_max_, il);
+      Index index_cmplx = il * (2 * h + 1) - h * h;
+      std::complex<double> c = coeffs[index_real];
+      output[index_cmplx + im] = c;
+      if (im > 0) {
+        output[index_cmplx - im] = sign * std::conj(c);
+      }
+      ++index_real;
+    }
+  }
+  return true;
+}
+
+SpectralCoeffs SHT::transform(const GridCoeffsRef &m,
+                              SHTWorkspace &workspace) const {
   if (is_trivial_) {
     return SpectralCoeffs::Constant(1, m(0, 0));
   }
-  set_spatial_coeffs(m);
-  auto shtns = ShtnsHandle::get(l_max_, m_max_, n_lon_, n_lat_);
-  spat_to_SH(shtns, spatial_coeffs_, spectral_coeffs_);
-  return get_spectral_coeffs();
+  assert(m.rows() == n_lon_);
+  assert(m.cols() == n_lat_);
+  detail::copy_spatial_coeffs(workspace.spatial_coeffs.get(), m);
+  auto shtns = get_shtns();
+  spat_to_SH(shtns, workspace.spatial_coeffs, workspace.spectral_coeffs);
+  SpectralCoeffs result(n_spectral_coeffs_);
+  detail::copy_spectral_coeffs(result, workspace.spectral_coeffs.get());
+  return result;
 }
 
-SpectralCoeffs SHT::transform_cmplx(const CmplxGridCoeffsRef &m) {
+SpectralCoeffs SHT::transform_cmplx(const CmplxGridCoeffsRef &m,
+                                    SHTWorkspace &workspace) const {
   if (is_trivial_) {
     return SpectralCoeffs::Constant(1, m(0, 0));
   }
-  set_spatial_coeffs(m);
-  auto shtns = ShtnsHandle::get(l_max_, m_max_, n_lon_, n_lat_);
-  spat_cplx_to_SH(shtns, cmplx_spatial_coeffs_, spectral_coeffs_cmplx_);
-  return get_spectral_coeffs_cmplx();
+  assert(m.rows() == n_lon_);
+  assert(m.cols() == n_lat_);
+  SpectralCoeffs result(n_spectral_coeffs_cmplx_);
+  if (transform_real_cmplx(result, m, workspace)) {
+    return result;
+  }
+  detail::copy_spatial_coeffs(workspace.cmplx_spatial_coeffs.get(), m);
+  auto shtns = get_shtns();
+  spat_cplx_to_SH(shtns,
+                  workspace.cmplx_spatial_coeffs,
+                  workspace.spectral_coeffs_cmplx);
+  detail::copy_spectral_coeffs(result, workspace.spectral_coeffs_cmplx.get());
+  return result;
 }
 
-GridCoeffs SHT::synthesize(const SpectralCoeffsRef &m) {
+GridCoeffs SHT::synthesize(const SpectralCoeffsRef &m,
+                           SHTWorkspace &workspace) const {
   if (is_trivial_) {
     return GridCoeffs::Constant(1, 1, m(0, 0).real());
   }
-  set_spectral_coeffs(m);
-  auto shtns = ShtnsHandle::get(l_max_, m_max_, n_lon_, n_lat_);
-  SH_to_spat(shtns, spectral_coeffs_, spatial_coeffs_);
-  return get_spatial_coeffs();
+  assert(m.size() == n_spectral_coeffs_);
+  detail::copy_spectral_coeffs(workspace.spectral_coeffs.get(), m);
+  auto shtns = get_shtns();
+  SH_to_spat(shtns, workspace.spectral_coeffs, workspace.spatial_coeffs);
+  GridCoeffs result(n_lon_, n_lat_);
+  detail::copy_spatial_coeffs(result, workspace.spatial_coeffs.get());
+  return result;
 }
 
-CmplxGridCoeffs SHT::synthesize_cmplx(const SpectralCoeffsRef &m) {
+CmplxGridCoeffs SHT::synthesize_cmplx(const SpectralCoeffsRef &m,
+                                      SHTWorkspace &workspace) const {
   if (is_trivial_) {
     return CmplxGridCoeffs::Constant(1, 1, m(0, 0).real());
   }
-  set_spectral_coeffs_cmplx(m);
-  auto shtns = ShtnsHandle::get(l_max_, m_max_, n_lon_, n_lat_);
-  SH_to_spat_cplx(shtns, spectral_coeffs_cmplx_, cmplx_spatial_coeffs_);
-  return get_cmplx_spatial_coeffs();
+  assert(m.size() == n_spectral_coeffs_cmplx_);
+  detail::copy_spectral_coeffs(workspace.spectral_coeffs_cmplx.get(), m);
+  auto shtns = get_shtns();
+  SH_to_spat_cplx(shtns,
+                  workspace.spectral_coeffs_cmplx,
+                  workspace.cmplx_spatial_coeffs);
+  CmplxGridCoeffs result(n_lon_, n_lat_);
+  detail::copy_spatial_coeffs(result, workspace.cmplx_spatial_coeffs.get());
+  return result;
+}
+
+void SHT::transform(eigen::VectorMapDynamic<std::complex<double>> output,
+                    eigen::ConstMatrixMapDynamic<double> m,
+                    SHTWorkspace &workspace) const {
+  if (is_trivial_) {
+    output[0] = m(0, 0);
+    return;
+  }
+  assert(m.rows() == n_lon_);
+  assert(m.cols() == n_lat_);
+  assert(output.size() == n_spectral_coeffs_);
+  // Input is always copied because SHTns may transform it in place.
+  detail::copy_spatial_coeffs(workspace.spatial_coeffs.get(), m);
+  auto shtns = get_shtns();
+  if ((output.innerStride() == 1) && detail::is_aligned(output.data())) {
+    spat_to_SH(shtns, workspace.spatial_coeffs, output.data());
+  } else {
+    spat_to_SH(shtns, workspace.spatial_coeffs, workspace.spectral_coeffs);
+    detail::copy_spectral_coeffs(output, workspace.spectral_coeffs.get());
+  }
+}
+
+void SHT::transform_cmplx(eigen::VectorMapDynamic<std::complex<double>> output,
+                          eigen::ConstMatrixMapDynamic<std::complex<double>> m,
+                          SHTWorkspace &workspace) const {
+  if (is_trivial_) {
+    output[0] = m(0, 0);
+    return;
+  }
+  assert(m.rows() == n_lon_);
+  assert(m.cols() == n_lat_);
+  assert(output.size() == n_spectral_coeffs_cmplx_);
+  if (transform_real_cmplx(output, m, workspace)) {
+    return;
+  }
+  detail::copy_spatial_coeffs(workspace.cmplx_spatial_coeffs.get(), m);
+  auto shtns = get_shtns();
+  if ((output.innerStride() == 1) && detail::is_aligned(output.data())) {
+    spat_cplx_to_SH(shtns, workspace.cmplx_spatial_coeffs, output.data());
+  } else {
+    spat_cplx_to_SH(shtns,
+                    workspace.cmplx_spatial_coeffs,
+                    workspace.spectral_coeffs_cmplx);
+    detail::copy_spectral_coeffs(output, workspace.spectral_coeffs_cmplx.get());
+  }
+}
+
+void SHT::synthesize(eigen::MatrixMapDynamic<double> output,
+                     eigen::ConstVectorMapDynamic<std::complex<double>> m,
+                     SHTWorkspace &workspace) const {
+  if (is_trivial_) {
+    output(0, 0) = m[0].real();
+    return;
+  }
+  assert(m.size() == n_spectral_coeffs_);
+  assert(output.rows() == n_lon_);
+  assert(output.cols() == n_lat_);
+  detail::copy_spectral_coeffs(workspace.spectral_coeffs.get(), m);
+  auto shtns = get_shtns();
+  if (detail::is_contiguous(output) && detail::is_aligned(output.data())) {
+    SH_to_spat(shtns, workspace.spectral_coeffs, output.data());
+  } else {
+    SH_to_spat(shtns, workspace.spectral_coeffs, workspace.spatial_coeffs);
+    detail::copy_spatial_coeffs(output, workspace.spatial_coeffs.get());
+  }
+}
+
+void SHT::synthesize_cmplx(
+    eigen::MatrixMapDynamic<std::complex<double>> output,
+    eigen::ConstVectorMapDynamic<std::complex<double>> m,
+    SHTWorkspace &workspace) const {
+  if (is_trivial_) {
+    output(0, 0) = m[0].real();
+    return;
+  }
+  assert(m.size() == n_spectral_coeffs_cmplx_);
+  assert(output.rows() == n_lon_);
+  assert(output.cols() == n_lat_);
+  detail::copy_spectral_coeffs(workspace.spectral_coeffs_cmplx.get(), m);
+  auto shtns = get_shtns();
+  if (detail::is_contiguous(output) && detail::is_aligned(output.data())) {
+    SH_to_spat_cplx(shtns, workspace.spectral_coeffs_cmplx, output.data());
+  } else {
+    SH_to_spat_cplx(shtns,
+                    workspace.spectral_coeffs_cmplx,
+                    workspace.cmplx_spatial_coeffs);
+    detail::copy_spatial_coeffs(output, workspace.cmplx_spatial_coeffs.get());
+  }
+}
+
+void SHT::transform(eigen::VectorMapDynamic<std::complex<float>> output,
+                    eigen::ConstMatrixMapDynamic<float> m,
+                    SHTWorkspace &workspace) const {
+  if (is_trivial_) {
+    output[0] = m(0, 0);
+    return;
+  }
+  assert(m.rows() == n_lon_);
+  assert(m.cols() == n_lat_);
+  assert(output.size() == n_spectral_coeffs_);
+  detail::copy_spatial_coeffs(workspace.spatial_coeffs.get(), m);
+  auto shtns = get_shtns();
+  spat_to_SH(shtns, workspace.spatial_coeffs, workspace.spectral_coeffs);
+  detail::copy_spectral_coeffs(output, workspace.spectral_coeffs.get());
+}
+
+void SHT::transform_cmplx(eigen::VectorMapDynamic<std::complex<float>> output,
+                          eigen::ConstMatrixMapDynamic<std::complex<float>> m,
+                          SHTWorkspace &workspace) const {
+  if (is_trivial_) {
+    output[0] = m(0, 0);
+    return;
+  }
+  assert(m.rows() == n_lon_);
+  assert(m.cols() == n_lat_);
+  assert(output.size() == n_spectral_coeffs_cmplx_);
+  if (transform_real_cmplx(output, m, workspace)) {
+    return;
+  }
+  detail::copy_spatial_coeffs(workspace.cmplx_spatial_coeffs.get(), m);
+  auto shtns = get_shtns();
+  spat_cplx_to_SH(shtns,
+                  workspace.cmplx_spatial_coeffs,
+                  workspace.spectral_coeffs_cmplx);
+  detail::copy_spectral_coeffs(output, workspace.spectral_coeffs_cmplx.get());
+}
+
+void SHT::synthesize(eigen::MatrixMapDynamic<float> output,
+                     eigen::ConstVectorMapDynamic<std::complex<float>> m,
+                     SHTWorkspace &workspace) const {
+  if (is_trivial_) {
+    output(0, 0) = m[0].real();
+    return;
+  }
+  assert(m.size() == n_spectral_coeffs_);
+  assert(output.rows() == n_lon_);
+  assert(output.cols() == n_lat_);
+  detail::copy_spectral_coeffs(workspace.spectral_coeffs.get(), m);
+  auto shtns = get_shtns();
+  SH_to_spat(shtns, workspace.spectral_coeffs, workspace.spatial_coeffs);
+  detail::copy_spatial_coeffs(output, workspace.spatial_coeffs.get());
+}
+
+void SHT::synthesize_cmplx(
+    eigen::MatrixMapDynamic<std::complex<float>> output,
+    eigen::ConstVectorMapDynamic<std::complex<float>> m,
+    SHTWorkspace &workspace) const {
+  if (is_trivial_) {
+    output(0, 0) = m[0].real();
+    return;
+  }
+  assert(m.size() == n_spectral_coeffs_cmplx_);
+  assert(output.rows() == n_lon_);
+  assert(output.cols() == n_lat_);
+  detail::copy_spectral_coeffs(workspace.spectral_coeffs_cmplx.get(), m);
+  auto shtns = get_shtns();
+  SH_to_spat_cplx(shtns,
+                  workspace.spectral_coeffs_cmplx,
+                  workspace.cmplx_spatial_coeffs);
+  detail::copy_spatial_coeffs(output, workspace.cmplx_spatial_coeffs.get());
+}
+
+template <typename Scalar>
+void SHT::transform_batch_impl(
+    eigen::TensorMap<std::complex<Scalar>, 2> output,
+    eigen::ConstTensorMap<Scalar, 3> fields,
+    SHTWorkspace &workspace) const {
+  Index n_fields = fields.dimension(2);
+  assert(output.dimension(0) == n_spectral_coeffs_);
+  assert(output.dimension(1) == n_fields);
+  if (is_trivial_) {
+    for (Index k = 0; k < n_fields; ++k) {
+      output(0, k) = fields(0, 0, k);
+    }
+    return;
+  }
+  assert(fields.dimension(0) == n_lon_);
+  assert(fields.dimension(1) == n_lat_);
+
+  auto shtns = get_shtns(n_fields);
+  const Scalar *in = fields.data();
+  std::complex<Scalar> *out = output.data();
+  Index n_spatial = n_lon_ * n_lat_;
+  Index n_threads = get_n_threads_across(n_fields);
+
+#ifdef _OPENMP
+#pragma omp parallel num_threads(n_threads) if (n_threads > 1)
+#endif
+  {
+    // Copies of a workspace share their buffers, so each thread only
+    // allocates new buffers when the fields are actually distributed.
+    auto thread_workspace = (n_threads > 1) ? create_workspace() : workspace;
+    double *spatial = thread_workspace.spatial_coeffs;
+    std::complex<double> *spectral = thread_workspace.spectral_coeffs;
+
+#ifdef _OPENMP
+#pragma omp for
+#endif
+    for (Index k = 0; k < n_fields; ++k) {
+      for (Index i = 0; i < n_spatial; ++i) {
+        spatial[i] = in[i * n_fields + k];
+      }
+      spat_to_SH(shtns, spatial, spectral);
+      for (Index i = 0; i < n_spectral_coeffs_; ++i) {
+        out[i * n_fields + k] = spectral[i];
+      }
+    }
+  }
+}
+
+void SHT::transform_batch(eigen::TensorMap<std::complex<double>, 2> output,
+                          eigen::ConstTensorMap<double, 3> fields,
+                          SHTWorkspace &workspace) const {
+  transform_batch_impl(output, fields, workspace);
+}
+
+void SHT::transform_batch(eigen::TensorMap<std::complex<float>, 2> output,
+                          eigen::ConstTensorMap<float, 3> fields,
+                          SHTWorkspace &workspace) const {
+  transform_batch_impl(output, fields, workspace);
+}
+
+eigen::Tensor<std::complex<double>, 2> SHT::transform_batch(
+    const eigen::Tensor<double, 3> &fields) const {
+  Index n_fields = fields.dimension(2);
+  eigen::Tensor<std::complex<double>, 2> output{n_spectral_coeffs_, n_fields};
+  auto workspace = create_workspace();
+  transform_batch(eigen::TensorMap<std::complex<double>, 2>(output.data(),
+                                                            output.dimensions()),
+                  eigen::ConstTensorMap<double, 3>(fields.data(),
+                                                   fields.dimensions()),
+                  workspace);
+  return output;
+}
+
+template <typename Scalar>
+void SHT::synthesize_batch_impl(
+    eigen::TensorMap<Scalar, 3> output,
+    eigen::ConstTensorMap<std::complex<Scalar>, 2> coeffs,
+    SHTWorkspace &workspace) const {
+  Index n_fields = coeffs.dimension(1);
+  assert(coeffs.dimension(0) == n_spectral_coeffs_);
+  assert(output.dimension(2) == n_fields);
+  if (is_trivial_) {
+    for (Index k = 0; k < n_fields; ++k) {
+      output(0, 0, k) = coeffs(0, k).real();
+    }
+    return;
+  }
+  assert(output.dimension(0) == n_lon_);
+  assert(output.dimension(1) == n_lat_);
+
+  auto shtns = get_shtns(n_fields);
+  const std::complex<Scalar> *in = coeffs.data();
+  Scalar *out = output.data();
+  Index n_spatial = n_lon_ * n_lat_;
+  Index n_threads = get_n_threads_across(n_fields);
+
+#ifdef _OPENMP
+#pragma omp parallel num_threads(n_threads) if (n_threads > 1)
+#endif
+  {
+    auto thread_workspace = (n_threads > 1) ? create_workspace() : workspace;
+    double *spatial = thread_workspace.spatial_coeffs;
+    std::complex<double> *spectral = thread_workspace.spectral_coeffs;
+
+#ifdef _OPENMP
+#pragma omp for
+#endif
+    for (Index k = 0; k < n_fields; ++k) {
+      for (Index i = 0; i < n_spectral_coeffs_; ++i) {
+        spectral[i] = in[i * n_fields + k];
+      }
+      SH_to_spat(shtns, spectral, spatial);
+      for (Index i = 0; i < n_spatial; ++i) {
+        out[i * n_fields + k] = spatial[i];
+      }
+    }
+  }
+}
+
+void SHT::synthesize_batch(eigen::TensorMap<double, 3> output,
+                           eigen::ConstTensorMap<std::complex<double>, 2> coeffs,
+                           SHTWorkspace &workspace) const {
+  synthesize_batch_impl(output, coeffs, workspace);
+}
+
+void SHT::synthesize_batch(eigen::TensorMap<float, 3> output,
+                           eigen::ConstTensorMap<std::complex<float>, 2> coeffs,
+                           SHTWorkspace &workspace) const {
+  synthesize_batch_impl(output, coeffs, workspace);
+}
+
+eigen::Tensor<double, 3> SHT::synthesize_batch(
+    const eigen::Tensor<std::complex<double>, 2> &coeffs) const {
+  Index n_fields = coeffs.dimension(1);
+  Index n_lon = is_trivial_ ? 1 : n_lon_;
+  Index n_lat = is_trivial_ ? 1 : n_lat_;
+  eigen::Tensor<double, 3> output{n_lon, n_lat, n_fields};
+  auto workspace = create_workspace();
+  synthesize_batch(eigen::TensorMap<double, 3>(output.data(),
+                                               output.dimensions()),
+                   eigen::ConstTensorMap<std::complex<double>, 2>(
+                       coeffs.data(),
+                       coeffs.dimensions()),
+                   workspace);
+  return output;
+}
+
+template <typename Scalar>
+void SHT::transform_cmplx_batch_impl(
+    eigen::TensorMap<std::complex<Scalar>, 2> output,
+    eigen::ConstTensorMap<std::complex<Scalar>, 3> fields,
+    SHTWorkspace &workspace) const {
+  Index n_fields = fields.dimension(2);
+  assert(output.dimension(0) == n_spectral_coeffs_cmplx_);
+  assert(output.dimension(1) == n_fields);
+  if (is_trivial_) {
+    for (Index k = 0; k < n_fields; ++k) {
+      output(0, k) = fields(0, 0, k);
+    }
+    return;
+  }
+  assert(fields.dimension(0) == n_lon_);
+  assert(fields.dimension(1) == n_lat_);
+
+  auto shtns = get_shtns(n_fields);
+  const std::complex<Scalar> *in = fields.data();
+  std::complex<Scalar> *out = output.data();
+  Index n_spatial = n_lon_ * n_lat_;
+  Index n_threads = get_n_threads_across(n_fields);
+
+#ifdef _OPENMP
+#pragma omp parallel num_threads(n_threads) if (n_threads > 1)
+#endif
+  {
+    auto thread_workspace = (n_threads > 1) ? create_workspace() : workspace;
+    std::complex<double> *spatial = thread_workspace.cmplx_spatial_coeffs;
+    std::complex<double> *spectral = thread_workspace.spectral_coeffs_cmplx;
+    eigen::ConstMatrixMap<std::complex<double>> field(spatial, n_lon_, n_lat_);
+
+#ifdef _OPENMP
+#pragma omp for
+#endif
+    for (Index k = 0; k < n_fields; ++k) {
+      for (Index i = 0; i < n_spatial; ++i) {
+        spatial[i] = in[i * n_fields + k];
+      }
+      if (!transform_real_cmplx(spectral, field, thread_workspace)) {
+        spat_cplx_to_SH(shtns, spatial, spectral);
+      }
+      for (Index i = 0; i < n_spectral_coeffs_cmplx_; ++i) {
+        out[i * n_fields + k] = spectral[i];
+      }
+    }
+  }
+}
+
+void SHT::transform_cmplx_batch(
+    eigen::TensorMap<std::complex<double>, 2> output,
+    eigen::ConstTensorMap<std::complex<double>, 3> fields,
+    SHTWorkspace &workspace) const {
+  transform_cmplx_batch_impl(output, fields, workspace);
+}
+
+void SHT::transform_cmplx_batch(
+    eigen::TensorMap<std::complex<float>, 2> output,
+    eigen::ConstTensorMap<std::complex<float>, 3> fields,
+    SHTWorkspace &workspace) const {
+  transform_cmplx_batch_impl(output, fields, workspace);
+}
+
+template <typename Scalar>
+void SHT::synthesize_cmplx_batch_impl(
+    eigen::TensorMap<std::complex<Scalar>, 3> output,
+    eigen::ConstTensorMap<std::complex<Scalar>, 2> coeffs,
+    SHTWorkspace &workspace) const {
+  Index n_fields = coeffs.dimension(1);
+  assert(coeffs.dimension(0) == n_spectral_coeffs_cmplx_);
+  assert(output.dimension(2) == n_fields);
+  if (is_trivial_) {
+    for (Index k = 0; k < n_fields; ++k) {
+      output(0, 0, k) = coeffs(0, k).real();
+    }
+    return;
+  }
+  assert(output.dimension(0) == n_lon_);
+  assert(output.dimension(1) == n_lat_);
+
+  auto shtns = get_shtns(n_fields);
+  const std::complex<Scalar> *in = coeffs.data();
+  std::complex<Scalar> *out = output.data();
+  Index n_spatial = n_lon_ * n_lat_;
+  Index n_threads = get_n_threads_across(n_fields);
+
+#ifdef _OPENMP
+#pragma omp parallel num_threads(n_threads) if (n_threads > 1)
+#endif
+  {
+    auto thread_workspace = (n_threads > 1) ? create_workspace() : workspace;
+    std::complex<double> *spatial = thread_workspace.cmplx_spatial_coeffs;
+    std::complex<double> *spectral = thread_workspace.spectral_coeffs_cmplx;
+
+#ifdef _OPENMP
+#pragma omp for
+#endif
+    for (Index k = 0; k < n_fields; ++k) {
+      for (Index i = 0; i < n_spectral_coeffs_cmplx_; ++i) {
+        spectral[i] = in[i * n_fields + k];
+      }
+      SH_to_spat_cplx(shtns, spectral, spatial);
+      for (Index i = 0; i < n_spatial; ++i) {
+        out[i * n_fields + k] = spatial[i];
+      }
+    }
+  }
+}
+
+void SHT::synthesize_cmplx_batch(
+    eigen::TensorMap<std::complex<double>, 3> output,
+    eigen::ConstTensorMap<std::complex<double>, 2> coeffs,
+    SHTWorkspace &workspace) const {
+  synthesize_cmplx_batch_impl(output, coeffs, workspace);
+}
+
+void SHT::synthesize_cmplx_batch(
+    eigen::TensorMap<std::complex<float>, 3> output,
+    eigen::ConstTensorMap<std::complex<float>, 2> coeffs,
+    SHTWorkspace &workspace) const {
+  synthesize_cmplx_batch_impl(output, coeffs, workspace);
 }
 
 eigen::Vector<double> SHT::evaluate(
     const SpectralCoeffsRef &m,
-    const eigen::MatrixFixedRows<double, 2> &points) {
+    const eigen::MatrixFixedRows<double, 2> &points) const {
+  Index n_points = points.rows();
   if (is_trivial_) {
-    return eigen::Vector<double>::Constant(1, 1, m(0, 0).real());
+    return eigen::Vector<double>::Constant(n_points, m[0].real());
   }
-  set_spectral_coeffs(m);
-  int n_points = points.rows();
+  assert(m.size() == n_spectral_coeffs_);
   eigen::Vector<double> result(n_points);
-  auto shtns = ShtnsHandle::get(l_max_, m_max_, n_lon_, n_lat_);
-  for (int i = 0; i < n_points; ++i) {
-    result[i] =
-        SH_to_point(shtns, spectral_coeffs_, cos(points(i, 1)), points(i, 0));
+  if (n_points == 0) {
+    return result;
+  }
+
+  // Sort points by co-latitude so that the Legendre functions need to be
+  // computed only once for each distinct co-latitude.
+  std::vector<Index> indices(n_points);
+  for (Index i = 0; i < n_points; ++i) {
+    indices[i] = i;
+  }
+  std::sort(indices.begin(), indices.end(), [&points](Index i, Index j) {
+    return points(i, 1) < points(j, 1);
+  });
+
+  auto shtns = get_shtns();
+  std::vector<double> legendre(l_max_ + 1);
+  std::vector<std::complex<double>> fourier_coeffs(m_max_ + 1);
+  std::vector<double> values, cos_m_phi, sin_m_phi, cos_phi, sin_phi;
+
+  Index group_start = 0;
+  while (group_start < n_points) {
+    double theta = points(indices[group_start], 1);
+    Index group_end = group_start + 1;
+    while ((group_end < n_points) && (points(indices[group_end], 1) == theta)) {
+      ++group_end;
+    }
+    Index n_group = group_end - group_start;
+
+    // Fourier coefficients of the field along the latitude circle.
+    double cos_theta = cos(theta);
+    Index index = 0;
+    for (Index im = 0; im <= m_max_; ++im) {
+      legendre_sphPlm_array(shtns, l_max_, im, cos_theta, legendre.data());
+      std::complex<double> f = 0.0;
+      for (Index l = im; l <= l_max_; ++l) {
+        f += legendre[l - im] * m[index];
+        ++index;
+      }
+      fourier_coeffs[im] = f;
+    }
+
+    // Synthesize longitudes for all points in group at once.
+    values.assign(n_group, fourier_coeffs[0].real());
+    cos_m_phi.assign(n_group, 1.0);
+    sin_m_phi.assign(n_group, 0.0);
+    cos_phi.resize(n_group);
+    sin_phi.resize(n_group);
+    for (Index i = 0; i < n_group; ++i) {
+      double phi = points(indices[group_start + i], 0);
+      cos_phi[i] = cos(phi);
+      sin_phi[i] = sin(phi);
+    }
+    for (Index im = 1; im <= m_max_; ++im) {
+      double f_r = 2.0 * fourier_coeffs[im].real();
+      double f_i = 2.0 * fourier_coeffs[im].imag();
+      for (Index i = 0; i < n_group; ++i) {
+        double c = cos_m_phi[i] * cos_phi[i] - sin_m_phi[i] * sin_phi[i];
+        double s = sin_m_phi[i] * cos_phi[i] + cos_m_phi[i] * sin_phi[i];
+        cos_m_phi[i] = c;
+        sin_m_phi[i] = s;
+        values[i] += f_r * c - f_i * s;
+      }
+    }
+    for (Index i = 0; i < n_group; ++i) {
+      result[indices[group_start + i]] = values[i];
+    }
+    group_start = group_end;
   }
   return result;
 }
 
 eigen::Vector<double> SHT::evaluate(const SpectralCoeffsRef &m,
-                                    const eigen::Vector<double> &thetas) {
+                                    const eigen::Vector<double> &thetas) const {
   if (is_trivial_) {
-    return eigen::Vector<double>::Constant(1, 1, m(0, 0).real());
+    return eigen::Vector<double>::Constant(thetas.size(), m[0].real());
   }
   assert(m_max_ == 0);
-  set_spectral_coeffs(m);
-  int n_points = thetas.size();
-  eigen::Vector<double> result(n_points);
-  auto shtns = ShtnsHandle::get(l_max_, m_max_, n_lon_, n_lat_);
-  for (int i = 0; i < n_points; ++i) {
-    result[i] = SH_to_point(shtns, spectral_coeffs_, cos(thetas[i]), 0.0);
+  eigen::Vector<double> cos_thetas = thetas.array().cos();
+  return LegendreExpansion::get(l_max_, cos_thetas)->evaluate(m);
+}
+
+SpectralCoeffs SHT::rotate_z(const SpectralCoeffsRef &m, double alpha) const {
+  return rotate(m, alpha, 0.0, 0.0);
+}
+
+SpectralCoeffs SHT::rotate_y(const SpectralCoeffsRef &m, double beta) const {
+  return rotate(m, 0.0, beta, 0.0);
+}
+
+SpectralCoeffs SHT::rotate(const SpectralCoeffsRef &m,
+                           double alpha,
+                           double beta,
+                           double gamma) const {
+  SpectralCoeffs result = m;
+  if (is_trivial_) {
+    return result;
+  }
+  assert(m.size() == n_spectral_coeffs_);
+  assert((beta == 0.0) || (m_max_ == l_max_));
+  auto shtns = get_shtns();
+  if (gamma != 0.0) {
+    SH_Zrotate(shtns, result.data(), gamma, result.data());
+  }
+  if (beta != 0.0) {
+    SH_Yrotate(shtns, result.data(), beta, result.data());
+  }
+  if (alpha != 0.0) {
+    SH_Zrotate(shtns, result.data(), alpha, result.data());
   }
   return result;
 }
 
+void SHT::rotate(eigen::VectorMapDynamic<std::complex<double>> m,
+                 double alpha,
+                 double beta,
+                 double gamma) const {
+  m = rotate(SpectralCoeffs(m), alpha, beta, gamma);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// SpectralIndexMap
+////////////////////////////////////////////////////////////////////////////////
+
+SpectralIndexMap::SpectralIndexMap(const SHT &source,
+                                   const SHT &destination,
+                                   bool cmplx) {
+  Index l_max_s = source.get_l_max();
+  Index m_max_s = source.get_m_max();
+  Index l_max_d = destination.get_l_max();
+  Index m_max_d = destination.get_m_max();
+  Index l_max = std::min(l_max_s, l_max_d);
+  Index m_max = std::min(m_max_s, m_max_d);
+
+  if (cmplx) {
+    n_source_coeffs_ = source.get_n_spectral_coeffs_cmplx();
+    n_destination_coeffs_ = destination.get_n_spectral_coeffs_cmplx();
+    // Coefficients of complex transforms are stored in blocks of constant l
+    // with m running from -min(l, m_max) to min(l, m_max).
+    auto index = [](Index l, Index m, Index m_max) {
+      Index h = std::min(m_max, l);
+      return l * (2 * h + 1) - h * h + m;
+    };
+    for (Index l = 0; l <= l_max; ++l) {
+      Index h = std::min(m_max, l);
+      blocks_.push_back(Block{index(l, -h, m_max_s),
+                              index(l, -h, m_max_d),
+                              2 * h + 1});
+    }
+  } else {
+    n_source_coeffs_ = source.get_n_spectral_coeffs();
+    n_destination_coeffs_ = destination.get_n_spectral_coeffs();
+    // Coefficients of real transforms are stored in blocks of constant m
+    // with l running from m to l_max.
+    for (Index m = 0; m <= m_max; ++m) {
+      blocks_.push_back(Block{m * (l_max_s + 1) - (m * (m - 1)) / 2,
+                              m * (l_max_d + 1) - (m * (m - 1)) / 2,
+                              l_max - m + 1});
+    }
+  }
+}
+
+std::shared_ptr<const SpectralIndexMap> SpectralIndexMap::get(
+    const SHT &source,
+    const SHT &destination,
+    bool cmplx) {
+  std::array<Index, 9> key = {source.get_l_max(),
+                              source.get_m_max(),
+                              source.get_n_longitudes(),
+                              source.get_n_latitudes(),
+                              destination.get_l_max(),
+                              destination.get_m_max(),
+                              destination.get_n_longitudes(),
+                              destination.get_n_latitudes(),
+                              cmplx};
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto found = cache_.find(key);
+  if (found != cache_.end()) {
+    return found->second;
+  }
+  auto index_map =
+      std::make_shared<const SpectralIndexMap>(source, destination, cmplx);
+  cache_[key] = index_map;
+  return index_map;
+}
+
+std::mutex SpectralIndexMap::mutex_;
+std::map<std::array<Index, 9>, std::shared_ptr<const SpectralIndexMap>>
+    SpectralIndexMap::cache_;
+
 ////////////////////////////////////////////////////////////////////////////////
 // SHTProvider
 ////////////////////////////////////////////////////////////////////////////////
 
-SHTProvider::SHTProvider(){};
+SHTProvider::ShtPtr SHTProvider::get(Index l_max,
+                                     Index m_max,
+                                     Index n_lon,
+                                     Index n_lat) {
+  return get(SHTParams{l_max, m_max, n_lon, n_lat});
+}
+
+SHTProvider::ShtPtr SHTProvider::get(const SHT &sht) {
+  return get(sht.get_l_max(),
+             sht.get_m_max(),
+             sht.get_n_longitudes(),
+             sht.get_n_latitudes());
+}
 
-SHT &SHTProvider::get_sht_instance(SHTProvider::SHTParams params) {
-  if (sht_instances_.count(params) == 0) {
-    sht_instances_[params] =
-        std::make_unique<SHT>(params[0], params[1], params[2], params[3]);
+SHTProvider::ShtPtr SHTProvider::get(SHTParams params) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto found = entries_.find(params);
+    if (found != entries_.end()) {
+      lru_.splice(lru_.begin(), lru_, found->second.position);
+      return found->second.sht;
+    }
+  }
+
+  // Creating the SHT may require initializing SHTns, so do it without
+  // holding the lock. If another thread created the same instance in the
+  // meantime, the existing one is returned.
+  auto sht = std::make_shared<const SHT>(params[0], params[1], params[2], params[3]);
+  size_t n_bytes = calculate_memory_usage(params);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto found = entries_.find(params);
+  if (found != entries_.end()) {
+    lru_.splice(lru_.begin(), lru_, found->second.position);
+    return found->second.sht;
+  }
+  if (n_bytes <= memory_budget_) {
+    evict(memory_budget_ - n_bytes);
+    lru_.push_front(params);
+    entries_[params] = Entry{sht, n_bytes, lru_.begin()};
+    memory_usage_ += n_bytes;
+  }
+  return sht;
+}
+
+size_t SHTProvider::calculate_memory_usage(const SHTParams &params) {
+  Index l_max = params[0];
+  Index m_max = params[1];
+  if (l_max == 0) {
+    return sizeof(SHT);
+  }
+  Index n_spatial = params[2] * params[3];
+  Index n_spectral = SHT::calc_n_spectral_coeffs(l_max, m_max) +
+                     SHT::calc_n_spectral_coeffs_cmplx(l_max, m_max);
+  return sizeof(SHT) + n_spectral * sizeof(std::complex<double>) +
+         n_spatial * (sizeof(std::complex<double>) + sizeof(double));
+}
+
+void SHTProvider::evict(size_t n_bytes) {
+  while (!lru_.empty() && (memory_usage_ > n_bytes)) {
+    auto found = entries_.find(lru_.back());
+    memory_usage_ -= found->second.n_bytes;
+    entries_.erase(found);
+    lru_.pop_back();
   }
-  return *sht_instances_[params];
 }
 
+void SHTProvider::set_memory_budget(size_t n_bytes) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  memory_budget_ = n_bytes;
+  evict(memory_budget_);
+}
+
+size_t SHTProvider::get_memory_budget() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return memory_budget_;
+}
+
+size_t SHTProvider::get_memory_usage() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return memory_usage_;
+}
+
+size_t SHTProvider::get_size() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return lru_.size();
+}
+
+void SHTProvider::clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  evict(0);
+}
+
+std::mutex SHTProvider::mutex_;
+size_t SHTProvider::memory_budget_ = 256 * 1024 * 1024;
+size_t SHTProvider::memory_usage_ = 0;
+SHTProvider::LruList SHTProvider::lru_;
+std::map<SHTProvider::SHTParams, SHTProvider::Entry> SHTProvider::entries_;
+
 }  // namespace sht
 }  // namespace scattering
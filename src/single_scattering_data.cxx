@@ -95,7 +95,7 @@ SingleScatteringData::SingleScatteringData(
     eigen::VectorPtr<double> t_grid,
     eigen::VectorPtr<double> lon_inc,
     eigen::VectorPtr<double> lat_inc,
-    std::shared_ptr<sht::SHT> sht_scat,
+    std::shared_ptr<const sht::SHT> sht_scat,
     eigen::TensorPtr<std::complex<double>, 6> phase_matrix,
     eigen::TensorPtr<std::complex<double>, 6> extinction_matrix,
     eigen::TensorPtr<std::complex<double>, 6> absorption_vector,
@@ -128,7 +128,7 @@ SingleScatteringData::SingleScatteringData(
                 std::make_shared<eigen::Vector<double>>(t_grid),
                 std::make_shared<eigen::Vector<double>>(lon_inc),
                 std::make_shared<eigen::Vector<double>>(lat_inc),
-                std::make_shared<sht::SHT>(sht_scat),
+                sht::SHTProvider::get(sht_scat),
                 std::make_shared<eigen::Tensor<std::complex<double>, 6>>(phase_matrix),
                 std::make_shared<eigen::Tensor<std::complex<double>, 6>>(extinction_matrix),
                 std::make_shared<eigen::Tensor<std::complex<double>, 6>>(absorption_vector),
@@ -151,7 +151,7 @@ SingleScatteringData::SingleScatteringData(
                 std::make_shared<eigen::Vector<double>>(t_grid),
                 std::make_shared<eigen::Vector<double>>(lon_inc),
                 std::make_shared<eigen::Vector<double>>(lat_inc),
-                std::make_shared<sht::SHT>(
+                sht::SHTProvider::get(
                     sht::SHT(sht::SHT::calc_l_max(phase_matrix.dimension(4)))
                     ),
                 std::make_shared<eigen::Tensor<std::complex<double>, 6>>(phase_matrix),
@@ -173,7 +173,7 @@ SingleScatteringData::SingleScatteringData(
           std::make_shared<eigen::Vector<double>>(t_grid),
           std::make_shared<eigen::Vector<double>>(lon_inc),
           std::make_shared<eigen::Vector<double>>(lat_inc),
-          std::make_shared<sht::SHT>(l_max,
+          sht::SHTProvider::get(l_max,
                                      l_max,
                                      2 * l_max + 2,
                                      2 * l_max + 2),
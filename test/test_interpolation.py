@@ -7,6 +7,7 @@ import scipy.interpolate
 import scatlib
 from scatlib.interpolation import (interpolate,
                                    RegularGridInterpolator,
+                                   InterpolationMethod,
                                    downsample_dimension)
 #
 # Interpolation
@@ -68,6 +69,52 @@ def test_interpolation_with_precalculated_weights():
 
     assert(np.all(np.isclose(results, sp_results)))
 
+def test_batch_interpolation():
+    rank = 5
+    degree = 3
+
+    sizes = np.random.randint(4, 10, rank)
+    t = np.random.randn(*sizes)
+    grids = [np.arange(sizes[i]) for i in range(degree)]
+
+    positions = [g[:-1] + np.random.uniform(size=g.size - 1) for g in grids]
+    positions = np.array(list(itertools.product(*positions)))
+
+    sp_interpolator = sp.interpolate.RegularGridInterpolator(grids, t)
+    sp_results = sp_interpolator(positions)
+
+    interpolator = RegularGridInterpolator(grids)
+    results = interpolator.interpolate_batch(t, positions)
+
+    assert(results.shape == sp_results.shape)
+    assert(np.all(np.isclose(results, sp_results)))
+
+def test_cubic_interpolation():
+    """
+    Cubic interpolation must be exact for quadratic functions and more
+    accurate than linear interpolation for smooth functions.
+    """
+    grids = [np.sort(np.random.uniform(0, 2 * np.pi, 12)) for i in range(3)]
+    xx, yy, zz = np.meshgrid(*grids, indexing="ij")
+    t = np.zeros((12, 12, 12, 2, 2))
+    t[..., 0, 0] = 1.0 + xx - 0.5 * xx * yy + zz ** 2
+    t[..., 1, 1] = np.sin(xx) * np.cos(yy) * np.sin(zz)
+
+    positions = np.stack([np.random.uniform(g[0], g[-1], 100) for g in grids],
+                         axis=-1)
+    px, py, pz = positions.T
+
+    interpolator = RegularGridInterpolator(grids, InterpolationMethod.Cubic)
+    results = interpolator.interpolate_batch(t, positions)
+    assert np.all(np.isclose(results[:, 0, 0], 1.0 + px - 0.5 * px * py + pz ** 2))
+    reference = np.sin(px) * np.cos(py) * np.sin(pz)
+    error_cubic = np.abs(results[:, 1, 1] - reference).mean()
+
+    interpolator = RegularGridInterpolator(grids)
+    results = interpolator.interpolate_batch(t, positions)
+    error_linear = np.abs(results[:, 1, 1] - reference).mean()
+    assert error_cubic < error_linear
+
 def test_interpolation_degenerate_dimensions():
     rank = 5
     degree = 3
@@ -102,3 +149,16 @@ def test_downsampling():
 
 
 
+
+def test_downsampling_conservative():
+    x = np.sort(np.random.uniform(0, 2 * np.pi, 101))
+    x[0] = 0.0
+    x[-1] = 2.0 * np.pi
+    y = np.random.randn(10, 101)
+    x_new = np.sort(np.random.uniform(0, 2 * np.pi, 31))
+    y_new = downsample_dimension(y, x, x_new, 0.0, 2.0 * np.pi)
+
+    limits = np.concatenate([[0.0], 0.5 * (x_new[1:] + x_new[:-1]), [2.0 * np.pi]])
+    integral = np.sum(y_new * np.diff(limits), axis=-1)
+    integral_ref = np.trapz(y, x=x, axis=-1)
+    assert np.all(np.isclose(integral, integral_ref))
@@ -276,6 +276,45 @@ class TestScatteringDataFieldAzimuthallyRandom:
         assert np.all(np.isclose(data_fully_spectral.get_data()[..., 0],
                                  self.data.scattering_data_fully_spectral.get_data()[..., 0]))
 
+    def test_sparse_fully_spectral(self):
+        """
+        Ensure that the sparse fully-spectral representation of data that
+        is independent of the incoming-angle longitude reduces to the m = 0
+        modes and agrees with the dense representation.
+        """
+        data = self.data.scattering_data_gridded
+        sht_inc = self.data.scattering_data_fully_spectral.get_sht_inc()
+        sht = SHT(sht_inc.get_l_max(), 2, 8, sht_inc.get_n_latitudes())
+        lon_inc = sht.get_longitude_grid()
+        lat_inc = data.get_lat_inc()
+        values = data.get_data()
+        shape = list(values.shape)
+        shape[2] = lon_inc.size
+        values = np.broadcast_to(values, shape).copy()
+        gridded = ScatteringDataFieldGridded(data.get_f_grid(),
+                                             data.get_t_grid(),
+                                             lon_inc,
+                                             lat_inc,
+                                             data.get_lon_scat(),
+                                             data.get_lat_scat(),
+                                             values)
+        spectral = gridded.to_spectral()
+
+        dense = spectral.to_fully_spectral(sht)
+        sparse = spectral.to_fully_spectral(sht, True)
+        assert sparse.get_sht_inc().get_m_max() == 0
+        assert np.all(np.isclose(sparse.to_spectral().to_gridded().get_data(),
+                                 dense.to_spectral().to_gridded().get_data()))
+
+        # All-zero data keeps a non-trivial incoming-angle SHT and grids.
+        zero = (spectral * 0.0).to_fully_spectral(sht, True)
+        assert zero.get_sht_inc().get_l_max() >= 1
+        zero_spectral = zero.to_spectral()
+        zero_data = zero_spectral.get_data()
+        assert zero_data.shape[2] == zero_spectral.get_lon_inc().size
+        assert zero_data.shape[3] == zero_spectral.get_lat_inc().size
+        assert np.all(zero_data == 0.0)
+
     def test_downsampling(self):
         """
         Check consistency of integration functions for gridded and spectral format
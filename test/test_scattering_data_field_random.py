@@ -8,7 +8,10 @@ from scipy.special import roots_legendre
 from utils import (harmonic_random_field, ScatteringDataBase, get_latitude_grid)
 from scattering.scattering_data_field import (ScatteringDataFieldGridded,
                                            ScatteringDataFieldSpectral,
-                                           ScatteringDataFieldFullySpectral)
+                                           ScatteringDataFieldFullySpectral,
+                                           ScatteringDataFieldGriddedFloat,
+                                           SHT)
+from scattering.single_scattering_data import SingleScatteringData
 
 
 class ScatteringDataRandom(ScatteringDataBase):
@@ -127,6 +130,36 @@ class TestScatteringDataFieldRandom:
         assert np.all(np.isclose(reference, spectral_2.to_gridded().get_data()))
         assert np.all(np.isclose(reference, fully_spectral.to_spectral().to_gridded().get_data()))
 
+    def test_point_interpolation(self):
+        """
+        Interpolation to a single frequency and temperature is tested for all
+        data formats by comparison with interpolation along frequency and
+        temperature.
+        """
+        f_grid = self.data.f_grid
+        t_grid = self.data.t_grid
+        df = f_grid[1] - f_grid[0]
+        dt = t_grid[1] - t_grid[0]
+        frequencies = [f_grid[0], f_grid[3], f_grid[-1], f_grid[2] + 0.3 * df]
+        temperatures = [t_grid[0], t_grid[2], t_grid[-1], t_grid[1] + 0.6 * dt,
+                        t_grid[0] - 0.5 * dt, t_grid[-1] + 0.5 * dt]
+        fields = [self.data.scattering_data,
+                  self.data.scattering_data_spectral,
+                  self.data.scattering_data_fully_spectral]
+
+        for field in fields:
+            for f in frequencies:
+                for t in temperatures:
+                    for extrapolate in [False, True]:
+                        reference = field.interpolate_frequency(np.array([f]))
+                        reference = reference.interpolate_temperature(
+                            np.array([t]),
+                            extrapolate
+                        )
+                        reference = reference.get_data()[0, 0]
+                        data = field.interpolate_point(f, t, extrapolate)
+                        assert np.all(np.isclose(reference, data))
+
     def test_angle_interpolation(self):
         """
         Angle interpolation is tested for all data formats by converting them to gridded
@@ -316,6 +349,40 @@ class TestScatteringDataFieldRandom:
         assert np.all(np.isclose(data_fully_spectral.get_data()[..., 0],
                                  self.data.scattering_data_fully_spectral.get_data()[..., 0]))
 
+    def test_spectral_truncation(self):
+        """
+        Ensure that truncating and zero-padding the spectral representation
+        preserves the shared coefficients and zeros the others.
+        """
+        data_spectral = self.data.scattering_data_spectral
+        sht = data_spectral.get_sht_scat()
+        l_max = sht.get_l_max()
+        m_max = sht.get_m_max()
+        truncated = data_spectral.to_spectral(l_max - 2, m_max)
+        padded = truncated.to_spectral(l_max, m_max)
+
+        mask = sht.get_l_indices() <= l_max - 2
+        data = data_spectral.get_data()
+        data_padded = padded.get_data()
+        assert np.all(np.isclose(data_padded[..., mask, :], data[..., mask, :]))
+        assert np.all(data_padded[..., ~mask, :] == 0.0)
+
+    def test_compression(self):
+        """
+        Ensure that compression of the spectral representation respects the
+        tolerance and reports the truncation error of the result.
+        """
+        data_spectral = self.data.scattering_data_spectral
+        sht = data_spectral.get_sht_scat()
+        compressed, error = data_spectral.compress(1e-2)
+        sht_compressed = compressed.get_sht_scat()
+        l_max = sht_compressed.get_l_max()
+        m_max = sht_compressed.get_m_max()
+
+        assert error <= 1e-2
+        assert l_max <= sht.get_l_max()
+        assert np.isclose(error, data_spectral.get_truncation_error(l_max, m_max))
+
     def test_downsampling(self):
         """
         Check consistency of integration functions for gridded and spectral format
@@ -333,3 +400,67 @@ class TestScatteringDataFieldRandom:
         i_ref = scattering_data.integrate_scattering_angles()
         i_1 = data_downsampled_gridded.integrate_scattering_angles()
         assert np.all(np.isclose(i_ref, i_1))
+
+    def test_single_precision_round_trip(self):
+        """
+        Ensure that converting single-precision data to spectral format and
+        back agrees with the same conversion in double precision.
+        """
+        grids = [self.data.f_grid,
+                 self.data.t_grid,
+                 self.data.lon_inc,
+                 self.data.lat_inc,
+                 self.data.lon_scat,
+                 self.data.lat_scat]
+        field = ScatteringDataFieldGridded(*grids, self.data.data)
+        field_float = ScatteringDataFieldGriddedFloat(
+            *[g.astype(np.float32) for g in grids],
+            self.data.data.astype(np.float32)
+        )
+
+        data_ref = field.to_spectral().to_gridded().get_data()
+        data_float = field_float.to_spectral().to_gridded().get_data()
+        assert data_float.dtype == np.float32
+        assert np.all(np.isclose(data_float, data_ref, rtol=1e-4, atol=1e-4))
+
+    def test_lab_frame_conversion(self):
+        """
+        Ensure that rotating the spectral phase function to the lab frame
+        agrees with the lab-frame phase function of gridded data.
+        """
+        f_grid = np.ones(1)
+        t_grid = np.ones(1)
+        lon_inc = np.zeros(1)
+        lat_inc = np.zeros(1)
+        lon_scat = np.zeros(1)
+
+        def phase_function(lat_scat):
+            x = np.cos(lat_scat)
+            return 1.0 + 0.5 * x + 0.75 * (3.0 * x ** 2 - 1.0)
+
+        # Reference: Gridded lab-frame conversion on a dense grid, so that the
+        # interpolation to the scattering angles is accurate.
+        lat_scat = np.linspace(0, np.pi, 721)
+        phase_matrix = np.zeros((1, 1, 1, 1, 1, lat_scat.size, 6))
+        phase_matrix[..., 0] = phase_function(lat_scat)
+        ones = np.ones((1, 1, 1, 1, 1, 1, 1))
+        data = SingleScatteringData(f_grid, t_grid, lon_inc, lat_inc,
+                                    lon_scat, lat_scat, phase_matrix,
+                                    ones, ones, ones, ones)
+        data_lab = data.to_lab_frame(8, 64, 1)
+
+        # Spectral lab-frame conversion of the same phase function.
+        lat_scat = SHT(8, 0, 1, 32).get_latitude_grid()
+        field = np.zeros((1, 1, 1, 1, 1, lat_scat.size, 6))
+        field[..., 0] = phase_function(lat_scat)
+        spectral = ScatteringDataFieldGridded(f_grid, t_grid, lon_inc, lat_inc,
+                                              lon_scat, lat_scat,
+                                              field).to_spectral(8, 0)
+        gridded = spectral.to_lab_frame(data_lab.get_lat_inc()).to_gridded(64, 64)
+
+        assert np.all(np.isclose(gridded.get_lon_scat(), data_lab.get_lon_scat()))
+        assert np.all(np.isclose(gridded.get_lat_scat(), data_lab.get_lat_scat()))
+        reference = data_lab.get_phase_matrix_data()[..., 0]
+        assert np.all(np.isclose(gridded.get_data()[..., 0],
+                                 reference,
+                                 rtol=1e-3))
@@ -5,7 +5,7 @@ import numpy as np
 import matplotlib.pyplot as plt
 import pytest
 import scipy
-from scattering.sht import SHT
+from scattering.sht import SHT, ShtnsHandle
 from scipy.special import roots_legendre, sph_harm
 
 class TestSHT:
@@ -87,6 +87,36 @@ class TestSHT:
         zz_rec = self.sht.synthesize_cmplx(2.0 * coeffs)
         assert np.all(np.isclose(2.0 * zz, zz_rec))
 
+    def test_inverse_transform_cmplx_real(self):
+        """
+        Test that the complex transform of a real-valued field, which is
+        dispatched to the real transform, recovers the input field.
+        """
+        l = np.random.randint(1, self.l_max)
+        m = np.random.randint(-l, l)
+
+        xx, yy = np.meshgrid(self.lon_grid, self.lat_grid, indexing="ij")
+        zz = sph_harm(m, l, xx, yy).real.astype(np.complex128)
+        coeffs = self.sht.transform_cmplx(zz)
+        zz_rec = self.sht.synthesize_cmplx(coeffs)
+        assert np.all(np.isclose(zz, zz_rec))
+
+    def test_pole_weights(self):
+        """
+        Test that the pole weights reproduce the values of a zonal field at
+        the poles.
+        """
+        l = np.random.randint(1, self.l_max)
+
+        xx, yy = np.meshgrid(self.lon_grid, self.lat_grid, indexing="ij")
+        zz = sph_harm(0, l, xx, yy).real
+        coeffs = self.sht.transform(zz)[:self.l_max + 1].real
+
+        north = np.dot(self.sht.get_pole_weights(False), coeffs)
+        south = np.dot(self.sht.get_pole_weights(True), coeffs)
+        assert np.isclose(north, sph_harm(0, l, 0.0, 0.0).real)
+        assert np.isclose(south, sph_harm(0, l, 0.0, np.pi).real)
+
     def test_evaluate(self):
         """
         Test that evaluating the spectral representation reproduces the spatial
@@ -105,6 +135,107 @@ class TestSHT:
 
         assert np.all(np.isclose(zz, zz_ref.real.ravel()))
 
+    def test_batch_transform(self):
+        """
+        Test that batched transforms yield the same results as transforming
+        the fields one by one.
+        """
+        n_fields = 3
+        fields = np.random.rand(self.n_lon, self.n_lat, n_fields)
+        coeffs = self.sht.transform_batch(fields)
+        for i in range(n_fields):
+            coeffs_ref = self.sht.transform(fields[:, :, i])
+            assert np.all(np.isclose(coeffs[:, i], coeffs_ref))
+
+        fields_rec = self.sht.synthesize_batch(coeffs)
+        for i in range(n_fields):
+            fields_ref = self.sht.synthesize(coeffs[:, i])
+            assert np.all(np.isclose(fields_rec[:, :, i], fields_ref))
+
+    def test_threading(self):
+        """
+        Test that results don't depend on the number of threads used for
+        the transforms.
+        """
+        n_fields = 4
+        fields = np.random.rand(self.n_lon, self.n_lat, n_fields)
+        coeffs_ref = self.sht.transform_batch(fields)
+
+        n_threads = SHT.get_n_threads()
+        SHT.set_n_threads(2)
+        coeffs = self.sht.transform_batch(fields)
+        SHT.set_n_threads(n_threads)
+
+        assert np.all(np.isclose(coeffs, coeffs_ref))
+
+    def test_rotation(self):
+        """
+        Test that rotating the spectral representation of a field reproduces
+        the rotated field.
+        """
+        xx, yy = np.meshgrid(self.lat_grid, self.lon_grid, indexing="xy")
+        alpha, beta = np.random.uniform(0, np.pi, size=2)
+
+        zz = np.sin(xx) * np.cos(yy)
+        coeffs = self.sht.rotate_z(self.sht.transform(zz), alpha)
+        zz_ref = np.sin(xx) * np.cos(yy - alpha)
+        assert np.all(np.isclose(self.sht.synthesize(coeffs), zz_ref))
+
+        zz = np.cos(xx)
+        coeffs = self.sht.rotate_y(self.sht.transform(zz), beta)
+        zz_ref = (np.cos(xx) * np.cos(beta)
+                  + np.sin(xx) * np.sin(beta) * np.cos(yy))
+        assert np.all(np.isclose(self.sht.synthesize(coeffs), zz_ref))
+
+class TestShtnsHandle:
+    """
+    Tests the cache of SHTns configurations.
+    """
+    def setup_method(self):
+        self.capacity = ShtnsHandle.get_capacity()
+        ShtnsHandle.clear()
+        ShtnsHandle.reset_statistics()
+
+    def teardown_method(self):
+        ShtnsHandle.set_capacity(self.capacity)
+
+    def test_cache_statistics(self):
+        """
+        Alternate between two grids and ensure that hits, misses and evictions
+        are counted and that evicted configurations remain usable.
+        """
+        sht_1 = SHT(10, 10, 32, 32)
+        sht_2 = SHT(12, 12, 32, 32)
+        x = np.random.rand(32, 32)
+
+        ShtnsHandle.set_capacity(2)
+        coeffs_1 = sht_1.transform(x)
+        coeffs_2 = sht_2.transform(x)
+        sht_1.transform(x)
+        sht_2.transform(x)
+        assert ShtnsHandle.get_size() == 2
+        assert ShtnsHandle.get_misses() == 2
+        assert ShtnsHandle.get_hits() == 2
+        assert ShtnsHandle.get_evictions() == 0
+
+        ShtnsHandle.set_capacity(1)
+        assert ShtnsHandle.get_size() == 1
+        assert ShtnsHandle.get_evictions() == 1
+
+        for i in range(2):
+            assert np.all(np.isclose(sht_1.transform(x), coeffs_1))
+            assert np.all(np.isclose(sht_2.transform(x), coeffs_2))
+        assert ShtnsHandle.get_size() == 1
+        assert ShtnsHandle.get_misses() == 6
+        assert ShtnsHandle.get_hits() == 2
+        assert ShtnsHandle.get_evictions() == 5
+
+        ShtnsHandle.reset_statistics()
+        assert ShtnsHandle.get_hits() == 0
+        assert ShtnsHandle.get_misses() == 0
+        assert ShtnsHandle.get_evictions() == 0
+
+
 class TestLegendreExpansion:
     """
     Testing of spherical harmonics transform for 1D fields.